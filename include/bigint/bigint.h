@@ -13,6 +13,15 @@
     #define _X32
 #endif
 
+#if defined(_MSVC_INTEL)
+    #include <intrin.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+    #define _SSSE3
+    #include <tmmintrin.h>
+#endif
+
 #include <iostream>
 #include <string>
 #include <string.h>
@@ -54,6 +63,25 @@ static const short v64[256] =
 	-1,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
 };
 
+static const signed char v16[256] =
+{	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
 template <unsigned int N>
 class BigInt
 {
@@ -62,11 +90,11 @@ public:
 
 	// Constructors and Assignment
 private:
-	void base2(const cstr num);
-	void base8(const cstr num);
-	void base10(const cstr num);
-	void base16(const cstr num);
-	void base64(const cstr num);
+	int base2(const char* num, int len);
+	int base8(const char* num, int len);
+	int base10(const char* num, int len);
+	int base16(const char* num, int len);
+	int base64(const char* num, int len);
 public:
 	BigInt<N>();
 	BigInt<N>(const cstr num, int base);
@@ -78,6 +106,8 @@ public:
 	BigInt<N>(const BigInt<N> &other);
 	BigInt<N>& operator=(const BigInt<N> &other);
 
+	int fromChars(const char* num, int len, int base = 0);
+
 
 	// Bitwise Operators
 	BigInt<N> operator&(const BigInt<N> &right) const;
@@ -93,6 +123,7 @@ public:
 	BigInt<N> operator~() const;
 	int byteCount() const;
 	int bitCount() const;
+	int zeroCount() const;
 
 
 	// Relational Operators
@@ -133,6 +164,9 @@ public:
 
 	// Extra Arithmetic Functions
 	static void div(const BigInt<N> &left, const BigInt<N> &right, BigInt<N> *qptr, BigInt<N> *rptr);
+	static void mulMod(const BigInt<N> &a, const BigInt<N> &b, const BigInt<N> &mod, BigInt<N> *res);
+	BigInt<N>& mulAdd(const BigInt<N> &a, const BigInt<N> &b);
+	BigInt<N>& subMul(const BigInt<N> &a, const BigInt<N> &b);
 	//pow<N>()
 
 
@@ -142,6 +176,13 @@ public:
 	}
 
 	// Stream and String Operators
+private:
+	int chars2(char* buf)  const;
+	int chars8(char* buf)  const;
+	int chars10(char* buf) const;
+	int chars16(char* buf) const;
+	int chars64(char* buf) const;
+	int chars(char* buf, int base) const;
 public:
 	str str2()  const;
 	str str8()  const;
@@ -151,9 +192,13 @@ public:
 public:
 	int length() const;
 	str toString(int base = 10, bool prefix = false) const;
+	int toChars(char* buf, int size, int base = 10, bool prefix = false) const;
+	static int maxChars(int base);
 
-	friend std::ostream& operator<<(std::ostream &o, const BigInt<N> num)
-	{	o << num.str10();
+	friend std::ostream& operator<<(std::ostream &o, const BigInt<N> &num)
+	{	char digits[N * 241 / 100 + 2];
+		num.toChars(digits, sizeof(digits));
+		o << digits;
 		return o;
 	}
 
@@ -166,6 +211,11 @@ public:
 
 };
 
+#include "bigint_limbs.cpp"
+#include "bigint_scratch.cpp"
+#include "bigint_multiply.cpp"
+#include "bigint_divide.cpp"
+#include "bigint_radix.cpp"
 #include "bigint_constructors.cpp"
 #include "bigint_bitwise.cpp"
 #include "bigint_relational.cpp"
@@ -1,4 +1,4 @@
-#include "BigInt.h"
+#include "bigint.h"
 //----------------------------------------------------------------------------//
 //                       Increment and Decrement Operators                    //
 //--------------------------------------------------------------------------- //
@@ -69,6 +69,7 @@ BigInt<N>& BigInt<N>::operator++()
 	"1: \n"
 	    :
         : "m" (b), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
 	);
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -90,6 +91,7 @@ BigInt<N>& BigInt<N>::operator++()
     "1: \n"
         :
         : "m" (b), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
     );
 #endif
 
@@ -162,6 +164,7 @@ BigInt<N>& BigInt<N>::operator--()
 	"1: \n"
 	    :
         : "m" (b), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
 	);
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -183,6 +186,7 @@ BigInt<N>& BigInt<N>::operator--()
     "1: \n"
     :
     : "m" (b), "m" (len)
+    : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
     );
 #endif
 
@@ -373,6 +377,7 @@ BigInt<N>&  BigInt<N>::operator+=(const BigInt<N> &right)
     "1: \n"
         :
         : "m" (r), "m" (l), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
     );
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -394,6 +399,7 @@ BigInt<N>&  BigInt<N>::operator+=(const BigInt<N> &right)
     "1: \n"
         :
         : "m" (r), "m" (l), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
     );
 #endif
 
@@ -401,6 +407,7 @@ BigInt<N>&  BigInt<N>::operator+=(const BigInt<N> &right)
 }
 
 // Subtracts two Big Integers of N bytes in Assembly using SBB for subtract with borrow.
+// The carry flag is cleared first, so the lowest limbs are not subtracted with a stale borrow.
 // The value of the number is iterated through 4 bytes at a time (32 bit instructions).
 template <unsigned int N>
 BigInt<N>&  BigInt<N>::operator-=(const BigInt<N> &right)
@@ -415,6 +422,7 @@ BigInt<N>&  BigInt<N>::operator-=(const BigInt<N> &right)
 		mov rsi, r
 		mov rdi, l;
 		mov ecx, len;
+		clc;
 
 	next:
 		jecxz end;
@@ -434,6 +442,7 @@ BigInt<N>&  BigInt<N>::operator-=(const BigInt<N> &right)
 		mov esi, r
 		mov edi, l;
 		mov ecx, len;
+		clc;
 
 	next:
 		jecxz end;
@@ -453,6 +462,7 @@ BigInt<N>&  BigInt<N>::operator-=(const BigInt<N> &right)
 		"mov %0, %%rsi \n"
 		"mov %1, %%rdi \n"
 		"mov %2, %%ecx \n"
+		"clc \n"
 
 	"1: \n"
 		"jecxz 1f \n"
@@ -467,6 +477,7 @@ BigInt<N>&  BigInt<N>::operator-=(const BigInt<N> &right)
 	"1: \n"
         :
         : "m" (r), "m" (l), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
     );
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -474,6 +485,7 @@ BigInt<N>&  BigInt<N>::operator-=(const BigInt<N> &right)
 		"mov %0, %%esi \n"
 		"mov %1, %%edi \n"
 		"mov %2, %%ecx \n"
+		"clc \n"
 
 	"1: \n"
 		"jecxz 1f \n"
@@ -488,171 +500,138 @@ BigInt<N>&  BigInt<N>::operator-=(const BigInt<N> &right)
 	"1: \n"
         :
         : "m" (r), "m" (l), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
     );
 #endif
 
 	return *this;
 }
 
-// Karatsuba algorithm that multiples a byte array of N bytes by another array of N bytes.
-// 3 byte arrays of 2N size are used, but declared as one array for faster access.
-// Z1 is used for the Z1 part of the algorithm, while the other two arrays, t1 and t2 
-// are used for various temporary values to save space.
-// First the (L1+L2) * (R1+R2) part of Z1 is calculated. If an overflow occurred during
-// addition of either operands, Karatsuba of the same size is called, otherwise
-// Karatsuba of half the size is called, then the temporary arrays are cleared.
-// Z0=L2*R2 is calculated in T1, then subtracted from Z1 and added to T2 (result) so there is
-// no need for this value anymore and T1 can be cleared.
-// Z2=L1*R1 is calculated in T1, then subtracted from Z1.
-// Z2(T1) and Z1 are shifted and added to the result (T2), which is then copied into
-// the left hand operand to simulate the *= operand.
+// Multiplies the lower N bytes of left by N bytes of right into the 2N bytes of left.
+// Only the limbs up to the most significant non zero limb of each operand are multiplied,
+// so numbers that only use part of the N bytes, or operands of different lengths, do not
+// pay for the leading zeros. The left hand operand (and the right hand operand if it is
+// in the same buffer) is copied to the scratch arena of the thread along with the
+// temporaries of the multiplication. Operands smaller than a limb (4 bytes) use built
+// in multiplication.
 template <unsigned int N>
 static void karatsuba(char* left, const char* right)
 {
-	if (((BigInt<N>*)left)->isZero())
-		return;
-	if (((BigInt<N>*)right)->isZero())
-	{   memset(left, 0, N * 2);
+	if (N < sizeof(limb))
+	{	*(unsigned long long*)left = (unsigned long long)*(unsigned int*)left * *(unsigned int*)right;
 		return;
 	}
 
-	unsigned char stack[N * 6];
-	unsigned char* z1 = (unsigned char*)stack;
-	unsigned char* t1 = (unsigned char*)stack + N + N;
-	unsigned char* t2 = (unsigned char*)stack + N + N + N + N;
-	memset(stack, 0, N * 6);
-
-	//(L1+L2)
-	memcpy(z1, left, (N >> 1));
-	memcpy(t1, left + (N >> 1), (N >> 1));
-	*(BigInt<N>*)z1 += *(BigInt<N>*)t1;
-
-	//(R1+R2)
-	memcpy(t1, right, (N >> 1));
-	memcpy(t2, right + (N >> 1), (N >> 1));
-	*(BigInt<N>*)t1 += *(BigInt<N>*)t2;
-
-	//(L1+L2) * (R1+R2)
-	if (*(z1 + (N >> 1)) | *(t1 + (N >> 1)))
-		karatsuba<N>((char*)z1, (char*)t1);
-	else
-		karatsuba<(N >> 1)>((char*)z1, (char*)t1);
-
-	// Clear T1 and T2
-	memset(t1, 0, N * 4);
-
-	// Z0=L2*R2 in T1
-	memcpy(t1, left, (N >> 1));
-	karatsuba<(N >> 1)>((char*)t1, (char*)right);
-	memcpy(t2, t1, N);
-	*(BigInt<N * 2>*)z1 -= *(BigInt<N * 2>*)t1;
-
-	// Z2=L1*R1 in T1
-	memset(t1 + (N >> 1), 0, (N >> 1));
-	memcpy(t1, left + (N >> 1), (N >> 1));
-	karatsuba<(N >> 1)>((char*)t1, (char*)(right + (N >> 1)));
-	*(BigInt<N * 2>*)z1 -= *(BigInt<N * 2>*)t1;
-
-	// Result Z2 + Z1 + Z0 (shift adjusted)
-	*(BigInt<N>*)(t2 + N) += *(BigInt<N>*)t1;
-	memset(t1, 0, N >> 1);
-	memcpy(t1 + (N >> 1), z1, N + 1);
-	*(BigInt<N * 2>*)t2 += *(BigInt<N * 2>*)t1;
-
-	//Result
-	memcpy(left, t2, N * 2);
+	const int len = N / sizeof(limb);
+	ScratchFrame frame(N * 2 + limb_mul_scratch(len) * sizeof(limb));
+	limb* a = (limb*)frame.data();
+	limb* b = (limb*)right;
+
+	memcpy(a, left, N);
+	if (right + N > left && right < left + N * 2)
+	{	b = a + len;
+		memcpy(b, right, N);
+	}
+
+	memset(left, 0, N * 2);
+	limb_mul((limb*)left, a, limb_length(a, len), b, limb_length(b, len), a + len * 2);
 }
 
-// Squares a number that is N bytes long. (Must be power of 2 length, at least 8 bytes)
-// Uses the square expansion (a+b)^2 = a^2 + 2ab + b^2 to efficiently calculate the result.
-// [1] The integer is split in 2 halves to calculate a^2 and b^2, and copied to calculate ab.
-// [2] a^2 and b^2 is calculated using squaring, while ab is calculated using karatsuba. Ex: 84^2 = 8^2 + 8*4 + 4^2
-// [3] The results from Step 2 are bit adjusted. a^2 was already calculated in the correct shift.
-//     ab is shifted (N/2*8) + 1 bits (+1 because of 2ab) and added to a^2 + b^2 
+// Squares a number that is N bytes long into the 2N bytes of num.
+// Only the limbs up to the most significant non zero limb are squared. The number is
+// copied to the scratch arena of the thread along with the temporaries of the squaring.
+// Operands smaller than a limb (4 bytes) use built in multiplication.
 template <unsigned int N>
 static void square(char* num)
 {
-	char ab[N * 2];
-	
-// [1]
-	memcpy(num + N, num + N / 2, N / 2);
-	memset(num + N / 2, 0, N / 2);
-	memcpy(ab, num, N * 2);
-
-// [2]
-	square<N / 2>(num);
-	square<N / 2>(num + N);
-	karatsuba <N / 2>((char*)ab, (char*)(ab + N));
-
-// [3]
-	memset(ab + N, 0, N / 2);
-	*(BigInt<N * 2>*)ab <<= N*4+1;
-	*(BigInt<N * 2>*)num += *(BigInt<N * 2>*)ab;
-}
+	if (N < sizeof(limb))
+	{	*(unsigned long long*)num = (unsigned long long)*(unsigned int*)num * *(unsigned int*)num;
+		return;
+	}
 
-// Template Specialization of the Karatsuba function to multiply the operands
-// using built in multiplication once the operands are small enough (4 bytes).
-// This is used as an exit condition to the recursive Karatsuba function.
-template <>
-static void karatsuba<4>(char* left, const char* right)
-{   *(unsigned long long*)left *= *(unsigned long*)right;
-    return;
-}
+	const int len = N / sizeof(limb);
+	ScratchFrame frame(N + limb_mul_scratch(len) * sizeof(limb));
+	limb* a = (limb*)frame.data();
 
-// Template Specialization of the Square function to multiply the operands
-// using built in multiplication once the operands are small enough (4 bytes).
-// This is used as an exit condition to the recursive Square function.
-template <>
-static void square<4>(char* num)
-{
-	*(unsigned long long*)num *= *(unsigned long*)num;
-	return;
+	memcpy(a, num, N);
+	memset(num, 0, N * 2);
+	limb_sqr((limb*)num, a, limb_length(a, len), a + len);
 }
 
-// Multiplies a Big Integer of N bytes with another N Byte Big Integer using Karatsuba.
-// The left hand side is copied to a buffer of 2N bytes to allow for intermediate overflow.
-// The right side is copied to a buffer of N bytes just to allow for sign modifications.
-// Both right and left hand operands are checked for sign and converted to positive.
-// The positive operands are multiplied using Karatsuba, then truncated and sign adjusted.
+// Multiplies a Big Integer of N bytes with another N Byte Big Integer.
+// The product is calculated in a buffer of 2N bytes taken from the scratch arena
+// of the thread to allow for intermediate overflow, then truncated to N bytes.
 template <unsigned int N>
 BigInt<N>&  BigInt<N>::operator*=(const BigInt<N> &right)
 {
-    unsigned char left[N * 2];
-    unsigned char rightCpy[N];
+    ScratchFrame frame(N * 2);
+    unsigned char* left = frame.data();
 
     memset(left + N, 0, N);
     memcpy(left, bytes, N);
-    memcpy(rightCpy, &right, N);
 
-    karatsuba<(N)>((char*)left, (char*)rightCpy);
+    karatsuba<N>((char*)left, (char*)right.bytes);
     memcpy(bytes, left, N);
 
     return *this;
 }
 
-// Divides two Big Integers of N bytes using shift subtraction.
-// Both the left and right operands are copied to a new array to allow for modification.
-// The operands are checked for negative signs and are converted to positive.
-// The divisor is shifted to the left to have the same amount of bits as the dividend.
-// The divisor is compared to the dividend, and if smaller, it's subtracted, and a bit is
-// appended to the result(quotient). The dividend is continuously shifted to the right in
-// each iteration, until the result is shifted to the left until the divisor is back to
-// its original value.
-// The result(quotient) is sign adjusted and copied into the object and returned.
+// Divides two Big Integers of N bytes with div and keeps the quotient.
 template <unsigned int N>
 BigInt<N>& BigInt<N>::operator/=(const BigInt<N> &right)
+{
+	BigInt<N> remainder;
+	div(*this, right, this, &remainder);
+	return *this;
+}
+
+// Divides two Big Integers of N bytes with div and keeps the remainder.
+template <unsigned int N>
+BigInt<N>& BigInt<N>::operator%=(const BigInt<N> &right)
 {
 	BigInt<N> quotient;
-	BigInt<N> dividend(*this);
+	div(*this, right, &quotient, this);
+	return *this;
+}
+
+// Divides two Big Integers of N bytes, writing the quotient to qptr and the remainder to rptr,
+// which can be the operands. When N is a whole number of limbs, the values are divided with
+// Knuth's algorithm D on their significant limbs, one quotient limb per step. Otherwise the
+// divisor is shifted to the left to have the same amount of bits as the dividend, and is
+// subtracted from it whenever it is smaller while it is shifted back, one quotient bit per step.
+template <unsigned int N>
+void BigInt<N>::div(const BigInt<N> &left, const BigInt<N> &right, BigInt<N> *qptr, BigInt<N> *rptr)
+{
+	BigInt<N> quotient;
+	BigInt<N> dividend(left);
 	BigInt<N> divisor(right);
 
+	if (N % sizeof(limb) == 0)
+	{
+		const int len = N / sizeof(limb);
+		const limb* a = (const limb*)left.bytes;
+		const limb* b = (const limb*)right.bytes;
+		int na = limb_length(a, len);
+		int nb = limb_length(b, len);
+
+		if (nb > 0 && na >= nb)
+		{
+			ScratchFrame frame((na + nb + 1) * sizeof(limb));
+			memset(dividend.bytes, 0, N);
+			limb_divmod((limb*)quotient.bytes, (limb*)dividend.bytes, a, na, b, nb, (limb*)frame.data());
+		}
+
+		memcpy(qptr, &quotient, N);
+		memcpy(rptr, &dividend, N);
+		return;
+	}
+
 	int proc = dividend.bitCount() - divisor.bitCount();
 	divisor <<= proc;
-
 	while (proc > 0)
 	{
 		if (divisor <= dividend)
-		{   *(char*)&quotient |= 1;
+		{	*(char*)&quotient |= 1;
 			dividend -= divisor;
 		}
 
@@ -662,80 +641,128 @@ BigInt<N>& BigInt<N>::operator/=(const BigInt<N> &right)
 	}
 
 	if (divisor <= dividend)
-	{   *(char*)&quotient |= 1;
+	{	*(char*)&quotient |= 1;
 		dividend -= divisor;
 	}
 
-	memcpy(bytes, &quotient, N);
-	return *this;
+	memcpy(qptr, &quotient, N);
+	memcpy(rptr, &dividend, N);
 }
 
-// Divides two Big Integers of N bytes using shift subtraction.
-// Both the left and right operands are copied to a new array to allow for modification.
-// The operands are checked for negative signs and are converted to positive.
-// The divisor is shifted to the left to have the same amount of bits as the dividend.
-// The divisor is compared to the dividend, and if smaller, it's subtracted, and a bit is
-// appended to the result(quotient). The dividend is continuously shifted to the right in
-// each iteration, until the result is shifted to the left until the divisor is back to
-// its original value.
-// The remainder(dividend) is sign adjusted, copied into the object and returned.
+// Adds the product of a and b to the number, truncated to N bytes like the * operator.
+// The product is not stored: each limb of the shorter operand multiplies the longer one
+// and the row is added straight into the number, then its carry is rippled up.
+// Rows stop at the most significant limb of the number, so the truncated part is never
+// computed. When the number is one of the operands, it falls back to the operators.
 template <unsigned int N>
-BigInt<N>& BigInt<N>::operator%=(const BigInt<N> &right)
+BigInt<N>& BigInt<N>::mulAdd(const BigInt<N> &a, const BigInt<N> &b)
 {
-	BigInt<N> quotient;
-	BigInt<N> dividend(*this);
-	BigInt<N> divisor(right);
+	if (N % sizeof(limb) != 0 || &a == this || &b == this)
+	{	return *this += a * b;
+	}
 
-	int proc = dividend.bitCount() - divisor.bitCount();
-	divisor <<= proc;
+	const int len = N / sizeof(limb);
+	limb* r = (limb*)bytes;
+	const limb* x = (const limb*)a.bytes;
+	const limb* y = (const limb*)b.bytes;
+	int nx = limb_length(x, len);
+	int ny = limb_length(y, len);
 
-	while (proc > 0)
-	{
-		if (divisor <= dividend)
-		{   *(char*)&quotient |= 1;
-			dividend -= divisor;
-		}
+	if (nx < ny)
+	{	const limb* t = x; x = y; y = t;
+		int n = nx; nx = ny; ny = n;
+	}
 
-		quotient <<= 1;
-		divisor >>= 1;
-		proc--;
+	for (int i = 0; i < ny; i++)
+	{	int row = nx < len - i ? nx : len - i;
+		limb_inc(r + i + row, len - i - row, limb_addmul(r + i, x, row, y[i]));
 	}
 
-	if (divisor <= dividend)
-	{   *(char*)&quotient |= 1;
-		dividend -= divisor;
+	return *this;
+}
+
+// Subtracts the product of a and b from the number, truncated to N bytes like the * operator.
+// Works the same way as mulAdd, with the rows subtracted and their borrows rippled up.
+template <unsigned int N>
+BigInt<N>& BigInt<N>::subMul(const BigInt<N> &a, const BigInt<N> &b)
+{
+	if (N % sizeof(limb) != 0 || &a == this || &b == this)
+	{	return *this -= a * b;
+	}
+
+	const int len = N / sizeof(limb);
+	limb* r = (limb*)bytes;
+	const limb* x = (const limb*)a.bytes;
+	const limb* y = (const limb*)b.bytes;
+	int nx = limb_length(x, len);
+	int ny = limb_length(y, len);
+
+	if (nx < ny)
+	{	const limb* t = x; x = y; y = t;
+		int n = nx; nx = ny; ny = n;
+	}
+
+	for (int i = 0; i < ny; i++)
+	{	int row = nx < len - i ? nx : len - i;
+		limb_dec(r + i + row, len - i - row, limb_submul(r + i, x, row, y[i]));
 	}
 
-	memcpy(bytes, &dividend, N);
 	return *this;
 }
 
+// Multiplies a and b modulo mod into res, which can be any of the operands.
+// Unlike a * b % mod the product is not truncated: the significant limbs of the
+// operands are multiplied into 2N bytes of scratch memory, and only the significant
+// limbs of the product are divided by mod with Knuth's algorithm D. When N is not a
+// whole number of limbs, the product is divided as a Big Integer of 2N bytes.
+// There is no remainder modulo 0, so a modulus of 0 throws -1.
 template <unsigned int N>
-void BigInt<N>::div(const BigInt<N> &left, const BigInt<N> &right, BigInt<N> *qptr, BigInt<N> *rptr)
+void BigInt<N>::mulMod(const BigInt<N> &a, const BigInt<N> &b, const BigInt<N> &mod, BigInt<N> *res)
 {
-	BigInt<N> quotient;
-	BigInt<N> dividend(left);
-	BigInt<N> divisor(right);
+	if (mod.isZero())
+	{	throw -1;
+	}
 
-	int proc = dividend.bitCount() - divisor.bitCount();
-	divisor <<= proc;
-	while (proc > 0)
-	{
-		if (divisor <= dividend)
-		{	*(char*)&quotient |= 1;
-			dividend -= divisor;
-		}
+	if (N % sizeof(limb) != 0)
+	{	BigInt<N * 2> prod, m;
+		memcpy(prod.bytes, a.bytes, N);
+		memcpy(m.bytes, mod.bytes, N);
+		karatsuba<N>((char*)prod.bytes, (const char*)b.bytes);
+		prod %= m;
+		memcpy(res->bytes, prod.bytes, N);
+		return;
+	}
 
-		quotient <<= 1;
-		divisor >>= 1;
-		proc--;
+	const int len = N / sizeof(limb);
+	const limb* x = (const limb*)a.bytes;
+	const limb* y = (const limb*)b.bytes;
+	const limb* m = (const limb*)mod.bytes;
+	int nx = limb_length(x, len);
+	int ny = limb_length(y, len);
+	int nm = limb_length(m, len);
+
+	ScratchFrame frame((len * 8 + 2 + limb_mul_scratch(len)) * sizeof(limb));
+	limb* prod = (limb*)frame.data();
+	limb* rem  = prod + len * 2;
+	limb* quot = rem + len;
+	limb* next = quot + len * 2 + 1;
+
+	int np = nx + ny;
+	if (nx == 0 || ny == 0)
+	{	np = 0;
+	}
+	else
+	{	limb_mul(prod, x, nx, y, ny, next);
+		np = limb_length(prod, np);
 	}
 
-	if (divisor <= dividend)
-	{	*(char*)&quotient |= 1;
-		dividend -= divisor;
+	memset(rem, 0, len * sizeof(limb));
+	if (np < nm)
+	{	memcpy(rem, prod, np * sizeof(limb));
+	}
+	else
+	{	limb_divmod(quot, rem, prod, np, m, nm, next);
 	}
 
-	memcpy(qptr, &quotient, N);
-	memcpy(rptr, &dividend, N);
-}
\ No newline at end of file
+	memcpy(res->bytes, rem, N);
+}
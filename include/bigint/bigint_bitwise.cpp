@@ -135,6 +135,7 @@ BigInt<N>&  BigInt<N>::operator&=(const BigInt<N> &right)
 	"1: \n"
         :
         : "m" (r), "m" (l), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
 	);
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -155,6 +156,7 @@ BigInt<N>&  BigInt<N>::operator&=(const BigInt<N> &right)
     "1: \n"
         :
         : "m" (r), "m" (l), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
     );
 #endif
 
@@ -225,6 +227,7 @@ BigInt<N>&  BigInt<N>::operator|=(const BigInt<N> &right)
 	"1: \n"
 	    :
         : "m" (r), "m" (l), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
 	);
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -245,6 +248,7 @@ BigInt<N>&  BigInt<N>::operator|=(const BigInt<N> &right)
     "1: \n"
         :
         : "m" (r), "m" (l), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
     );
 #endif
 
@@ -315,6 +319,7 @@ BigInt<N>&  BigInt<N>::operator^=(const BigInt<N> &right)
 	"1: \n"
 	    :
         : "m" (r), "m" (l), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
 	);
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -335,268 +340,82 @@ BigInt<N>&  BigInt<N>::operator^=(const BigInt<N> &right)
 	"1: \n"
 	    :
         : "m" (r), "m" (l), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
 	);
 #endif
 
 	return *this;
 }
 
+// Shifts whole limbs with a move and the rest of the count with limb_shl, where every limb
+// is a funnel shift of two neighbouring limbs (SHLD on x86). Sizes that are not whole limbs
+// do the same with bytes.
 template <unsigned int N>
 BigInt<N>&  BigInt<N>::operator<<=(const int count)
 {
-	unsigned char* src = bytes + N - 4 - (count / 16) * 2;
-	unsigned char* dst = bytes + N - 2;
-	unsigned char* end = bytes;
-	unsigned char  sft = 16 - (count % 16);
-
-
-	if (count >= N * 8 || count < 0)
+	if (count >= (int)N * 8 || count < 0)
 	{
 		memset(bytes, 0, N);
 		return *this;
 	}
 
-#if defined(_MSVC_INTEL) && defined(_X64)
-    __asm
+	if (N % sizeof(limb) == 0)
 	{
-		mov rsi, src;
-		mov rdi, dst;
-		mov rdx, end;
-		mov cl, sft;
+		const int len = N / sizeof(limb);
+		const int words = count / LIMB_BITS;
+		limb* l = (limb*)bytes;
 
-	sh:
-		cmp rsi, rdx;
-		jl quit;
-
-		lodsd;
-		shr eax, cl;
-		stosw;
-
-		sub rsi, 6;
-		sub rdi, 4;
-		jmp sh;
-
-	quit:
-		add rsi, 2;
-		lodsw;
-		sub cl, 16;
-		neg cl;
-		shl ax, cl;
-		stosw;
-	}
-#elif defined(_MSVC_INTEL) && defined(_X32)
-	__asm
-	{
-		mov esi, src;
-		mov edi, dst;
-		mov edx, end;
-		mov cl, sft;
-
-	sh:
-		cmp esi, edx;
-		jl quit;
-
-		lodsd;
-		shr eax, cl;
-		stosw;
-
-		sub esi, 6;
-		sub edi, 4;
-		jmp sh;
-
-	quit:
-		add esi, 2;
-		lodsw;
-		sub cl, 16;
-		neg cl;
-		shl ax, cl;
-		stosw;
+		limb_shl(l + words, l, len - words, count % LIMB_BITS);
+		memset(l, 0, words * sizeof(limb));
+		return *this;
 	}
-#elif defined(_GAS_ATT) && defined(_X64)
-    __asm__
-	(
-		"mov %0, %%rsi \n"
-		"mov %1, %%rdi \n"
-		"mov %2, %%rdx \n"
-		"mov %3, %%cl \n"
-
-	"1: \n"
-		"cmp %%rdx, %%rsi \n"
-		"jl 1f \n"
-
-		"lodsl \n"
-		"shr %%cl, %%eax \n"
-		"stosw \n"
-
-		"sub $6, %%rsi \n"
-		"sub $4, %%rdi \n"
-		"jmp 1b \n"
 
-	"1: \n"
-		"add $2, %%rsi \n"
-		"lodsw \n"
-		"sub $16, %%cl \n"
-		"neg %%cl \n"
-		"shl %%cl, %%ax \n"
-		"stosw \n"
-		:
-        : "m" (src), "m" (dst), "m" (end), "m" (sft)
+	const int move = count / 8;
+	const int bits = count % 8;
 
-	);
-#elif defined(_GAS_ATT) && defined(_X32)
-    __asm__
-    (
-        "mov %0, %%esi \n"
-        "mov %1, %%edi \n"
-        "mov %2, %%edx \n"
-        "mov %3, %%cl \n"
-
-    "1: \n"
-        "cmp %%edx, %%esi \n"
-        "jl 1f \n"
-
-        "lodsl \n"
-        "shr %%cl, %%eax \n"
-        "stosw \n"
-
-        "sub $6, %%esi \n"
-        "sub $4, %%edi \n"
-        "jmp 1b \n"
+	memmove(bytes + move, bytes, N - move);
+	memset(bytes, 0, move);
 
-    "1: \n"
-        "add $2, %%esi \n"
-        "lodsw \n"
-        "sub $16, %%cl \n"
-        "neg %%cl \n"
-        "shl %%cl, %%ax \n"
-        "stosw \n"
-        :
-        : "m" (src), "m" (dst), "m" (end), "m" (sft)
-    );
-#endif
+	for (int i = N - 1; bits && i > move; i--)
+	{	bytes[i] = (unsigned char)((bytes[i] << bits) | (bytes[i - 1] >> (8 - bits)));
+	}
+	bytes[move] <<= bits;
 
-	memset(bytes, 0, (count / 16) * 2);
 	return *this;
 }
 
+// Shifts whole limbs with a move and the rest of the count with limb_shr (SHRD on x86)
 template <unsigned int N>
 BigInt<N>&  BigInt<N>::operator>>=(const int count)
 {
-	unsigned char* srcp = bytes + (count / 16) * 2;
-	unsigned char* dstp = bytes;
-	unsigned char* endp = bytes + N - 2;
-	unsigned char  sft = (count % 16);
-
-
-	if (count >= N * 8 || count < 0)
+	if (count >= (int)N * 8 || count < 0)
 	{
 		memset(bytes, 0, N);
 		return *this;
 	}
 
-#if defined(_MSVC_INTEL) && defined(_X64)
-    __asm
+	if (N % sizeof(limb) == 0)
 	{
-		mov rsi, srcp;
-		mov rdi, dstp;
-		mov rdx, endp;
-		mov cl, sft;
-
-	sh:
-		cmp rsi, rdx;
-		jge end;
-
-		lodsd;
-		shr eax, cl;
-		stosw;
+		const int len = N / sizeof(limb);
+		const int words = count / LIMB_BITS;
+		limb* l = (limb*)bytes;
 
-		sub rsi, 2;
-		jmp sh;
-
-	end:
-		lodsw;
-		shr ax, cl;
-		stosw;
+		limb_shr(l, l + words, len - words, count % LIMB_BITS);
+		memset(l + len - words, 0, words * sizeof(limb));
+		return *this;
 	}
-#elif defined(_MSVC_INTEL) && defined(_X32)
-	__asm
-	{
-		mov esi, srcp;
-		mov edi, dstp;
-		mov edx, endp;
-		mov cl, sft;
 
-	sh:
-		cmp esi, edx;
-		jge end;
+	const int move = count / 8;
+	const int bits = count % 8;
 
-		lodsd;
-		shr eax, cl;
-		stosw;
+	memmove(bytes, bytes + move, N - move);
+	memset(bytes + N - move, 0, move);
 
-		sub esi, 2;
-		jmp sh;
-
-	end:
-		lodsw;
-		shr ax, cl;
-		stosw;
+	for (int i = 0; bits && i < (int)N - move - 1; i++)
+	{	bytes[i] = (unsigned char)((bytes[i] >> bits) | (bytes[i + 1] << (8 - bits)));
 	}
-#elif defined(_GAS_ATT) && defined(_X64)
-    __asm__
-	(
-		"mov %0, %%rsi \n"
-		"mov %1, %%rdi \n"
-		"mov %2, %%rdx \n"
-		"mov %3, %%cl \n"
-
-	"1: \n"
-		"cmp %%rdx, %%rsi \n"
-		"jge 1f \n"
-
-		"lodsl \n"
-		"shr %%cl, %%eax \n"
-		"stosw \n"
-
-		"sub $2, %%rsi \n"
-		"jmp 1b \n"
-
-	"1: \n"
-		"lodsw \n"
-		"shr %%cl, %%ax \n"
-		"stosw \n"
-		:
-        : "m" (srcp), "m" (dstp), "m" (endp), "m" (sft)
-	);
-#elif defined(_GAS_ATT) && defined(_X32)
-    __asm__
-    (
-        "mov %0, %%esi \n"
-        "mov %1, %%edi \n"
-        "mov %2, %%edx \n"
-        "mov %3, %%cl \n"
-
-    "1: \n"
-        "cmp %%edx, %%esi \n"
-        "jge 1f \n"
-
-        "lodsl \n"
-        "shr %%cl, %%eax \n"
-        "stosw \n"
+	bytes[N - move - 1] >>= bits;
 
-        "sub $2, %%esi \n"
-        "jmp 1b \n"
-
-    "1: \n"
-        "lodsw \n"
-        "shr %%cl, %%ax \n"
-        "stosw \n"
-        :
-        : "m" (srcp), "m" (dstp), "m" (endp), "m" (sft)
-    );
-#endif
-
-	memset(bytes + N - (count / 8), 0, (count / 8));
 	return *this;
 }
 
@@ -665,6 +484,7 @@ BigInt<N> BigInt<N>::operator~() const
 	"1: \n"
 	    :
         : "m" (b), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
 	);
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -685,6 +505,7 @@ BigInt<N> BigInt<N>::operator~() const
     "1: \n"
         :
         : "m" (b), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
     );
 #endif
 
@@ -703,16 +524,42 @@ int BigInt<N>::byteCount() const
 }
 
 // Finds and returns the count of bits needed to represent the number (bit length)
-// Starting from the most significant byte, decrementing 8 from the initial count (N-1)*8 if the byte is 0
-// Once a byte is found that is non zero, it is right shifted repeatedly till it becomes 0, and the counter is incremented
+// The most significant non zero limb is found first, then its leading zeros are counted
+// with one instruction. Sizes that are not whole limbs count the leading zeros of a byte.
 template <unsigned int N>
 int BigInt<N>::bitCount() const
 {
-	int count = (N-1) << 3;
-	char* end = (char*)bytes + N - 1;
+	if (N % sizeof(limb) == 0)
+	{
+		const limb* l = (const limb*)bytes;
+		int len = limb_length(l, N / sizeof(limb));
+
+		return len ? len * LIMB_BITS - limb_clz(l[len - 1]) : 0;
+	}
 
-	for (; !*end && end > (char*)bytes; end--, count -= 8);
-	for (unsigned char nzbyte = *end;  nzbyte; nzbyte >>= 1, count++);
+	int count = byteCount();
+	return count ? count * 8 - limb_clz(bytes[count - 1]) + (LIMB_BITS - 8) : 0;
+}
 
-	return count;
+// Finds and returns the count of trailing 0 bits (the exponent of 2 in the number), N*8 for 0
+// Starting from the least significant limb, the first non zero limb gets its zeros counted
+// with one instruction.
+template <unsigned int N>
+int BigInt<N>::zeroCount() const
+{
+	if (N % sizeof(limb) == 0)
+	{
+		const limb* l = (const limb*)bytes;
+		for (int i = 0; i < (int)(N / sizeof(limb)); i++)
+		{	if (l[i])
+				return i * LIMB_BITS + limb_ctz(l[i]);
+		}
+		return N * 8;
+	}
+
+	for (int i = 0; i < (int)N; i++)
+	{	if (bytes[i])
+			return i * 8 + limb_ctz(bytes[i]);
+	}
+	return N * 8;
 }
@@ -4,132 +4,91 @@
 //--------------------------------------------------------------------------- //
 
 // Constructs a Big Integer of N bytes from a base 2 big endian string format of the number.
-// If the format is invalid, an exception is thrown. If too many digits are present, they are ignored.
+// If the format is invalid, -1 is returned, otherwise 0. If too many digits are present, they are ignored.
 // The pointer of the string is moved format if there are more digits than bytes.
-// The array of digits are processed one by one and assigned to the object 1 bit at a time
-// using |= and << for the correct positions within the byte in little endian format.
+// The digits in front that do not fill a whole byte are shifted into the top byte one by one,
+// the rest are checked and packed 8 at a time (see bin_decode).
 template <unsigned int N>
-void BigInt<N>::base2(cstr num)
+int BigInt<N>::base2(const char* num, int nlen)
 {
-	int nlen = strlen(num);
 	int len = nlen;
 	if (len > N * 8)
 		len = N * 8;
 
 	cstr ptr = num + nlen - len;
+	int  top = len / 8;
 	memset(bytes, 0, N);
 
-	for (int ch = len - 1, byte = 0, bit = 0; ch >= 0; ch--)
+	for (int ch = 0; ch < len % 8; ch++)
 	{
-		if ((unsigned char)(ptr[ch] - '0') <= 1)
-			bytes[byte] |= (ptr[ch] - '0') << bit;
-		else
-			throw - 1;
+		if ((unsigned char)(ptr[ch] - '0') > 1)
+			return -1;
 
-		if (++bit == 8)
-		{
-			byte++;
-			bit = 0;
-		}
+		bytes[top] = (bytes[top] << 1) | (ptr[ch] - '0');
 	}
+
+	return bin_decode(bytes, ptr + len % 8, top);
 }
 
 // Constructs a Big Integer of N bytes from a base 8 big endian string format of the number.
-// If the format is invalid, an exception is thrown. If too many digits are present, they are ignored.
-// The function first identifies the number of padding characters (=) to adjust the location and
-// value of the least significant digit. The value of digits are found from a lookup table where
-// the ascii value of the character is the index to the values. The 6 bit values are shifter
-// to the right position (<<) and added to the bytes (|=) one by one. 
+// If the format is invalid, -1 is returned, otherwise 0. If too many digits are present, they are ignored.
+// 8 octal digits are exactly 3 bytes, so the digits are read in groups of 8 from the end,
+// and each group is collected into 24 bits, then stored into the next 3 bytes.
 template <unsigned int N>
-void BigInt<N>::base8(const cstr num)
+int BigInt<N>::base8(const char* num, int nlen)
 {
-	int nlen = strlen(num);
 	memset(bytes, 0, N);
 
-	short digit;
-	int   shift = 0;
-
-	for (int ch = nlen - 1, byte = 0; ch >= 0 && byte<N; ch--)
+	for (int end = nlen, byte = 0; end > 0 && byte < N; end -= 8, byte += 3)
 	{
-		digit = num[ch] - '0';
-		if ((unsigned short)digit > 7)
-			throw - 1;
+		unsigned int group = 0;
 
-		digit <<= shift;
-		bytes[byte] |= *(char*)&digit;
+		for (int ch = (end > 8 ? end - 8 : 0); ch < end; ch++)
+		{
+			unsigned int digit = num[ch] - '0';
+			if (digit > 7)
+				return -1;
 
-		if (shift >= 5)
-			if (++byte < N)
-				bytes[byte] |= *(((char*)&digit) + 1);
+			group = (group << 3) | digit;
+		}
 
-		shift += 3;
-		if (shift >= 8)
-			shift -= 8;
+		for (int i = 0; i < 3 && byte + i < N; i++)
+			bytes[byte + i] = (unsigned char)(group >> (i * 8));
 	}
+	return 0;
 }
 
-// Constructs a Big Integer of N bytes from a base 10 big endian string format of the number, negative or positive.
-// The string is copied into a new array and adjusted to contain 0-9 as numbers in each index position.
-// If the format is invalid, an exception is thrown.
-// The array of numbers are repeatedly divided by 2 using right shift and carry in assembly and the 
-// number is constructed bit by bit in little endian format.
-// If the format was negative, the result is negated.
+// Constructs a Big Integer of N bytes from a base 10 big endian string format of the number.
+// If the format is invalid, -1 is returned, otherwise 0. If the number is too large, the high bits are lost.
+// The digits are checked and the leading 0s are skipped, then the digits are parsed into limbs,
+// up to a limb worth of digits at a time, or recursively for long strings (see limb_from_dec).
 template <unsigned int N>
-void BigInt<N>::base10(const cstr num)
+int BigInt<N>::base10(const char* num, int count)
 {
-    int len = strlen(num);
-
-	char* copy = new char[len + 1];
-	char* cend = copy + len;
-
-    memset(bytes, 0, N);
+	const int len = (N + sizeof(limb) - 1) / sizeof(limb);
+	limb  value[len];
+	cstr  digits = num;
 
-
-	for (int i = len; i > 0; i--)
-	{   copy[i] = num[i - 1] - '0';
-		if (num[i - 1] > '9' || num[i - 1] < '0')
-			throw - 1;
+	for (int i = 0; i < count; i++)
+	{	if (num[i] > '9' || num[i] < '0')
+			return -1;
 	}
-	copy[0] = -1;
 
-	unsigned char mask = 1;
-	for(int byte = 0; copy[len] !=- 1 && byte<N;)
-	{
-        if (copy[len] & 1)
-            bytes[byte] |= mask;
-        copy[len] >>= 1;
-
-        int i = len - 1;
-        for (; copy[i] != -1; i--)
-        {
-            if (copy[i] & 1)
-                copy[i + 1] += 5;
-            copy[i] >>= 1;
-        }
-
-        if (copy[i + 1] == 0)
-            copy[i + 1] = -1;
-
-        if (mask == 128)
-        {   mask = 1;
-            byte++;
-        }
-        else
-            mask <<= 1;
-    }
-
-    delete[] copy;
+	for (; count > 0 && *digits == '0'; digits++, count--);
+
+	limb_from_dec(value, len, digits, count);
+	memcpy(bytes, value, N);
+	return 0;
 }
 
 // Constructs a Big Integer of N bytes from a base 16 big endian string format of the number.
-// If the format is invalid, an exception is thrown. If too many digits are present, they are ignored.
+// If the format is invalid, -1 is returned, otherwise 0. If too many digits are present, they are ignored.
 // The pointer of the string is moved format if there are more digits than bytes.
-// The array of digits are processed one by one and assigned to the object 4 bits at a time
-// using |= and << for the correct positions within the byte in little endian format.
+// With an odd number of digits, the first one is the top byte on its own,
+// the rest are converted two digits per byte (see hex_decode).
 template <unsigned int N>
-void BigInt<N>::base16(const cstr num)
+int BigInt<N>::base16(const char* num, int nlen)
 {
-	int nlen = strlen(num);
 	int len = nlen;
 	if (len > N * 2)
 		len = N * 2;
@@ -137,49 +96,35 @@ void BigInt<N>::base16(const cstr num)
 	cstr ptr = num + nlen - len;
 	memset(bytes, 0, N);
 
-	for (int ch = len - 1, byte = 0; ch >= 0; ch--, byte++)
+	if (len & 1)
 	{
-		if ((unsigned char)(ptr[ch] - '0') <= 9)
-			bytes[byte] = (ptr[ch] - '0');
-		else if (ptr[ch] >= 'A' && ptr[ch] <= 'F')
-			bytes[byte] = (ptr[ch] - '7');
-		else if (ptr[ch] >= 'a' && ptr[ch] <= 'f')
-			bytes[byte] = (ptr[ch] - 'W');
-		else
-			throw - 1;
+		int digit = v16[(unsigned char)*ptr++];
+		if (digit < 0)
+			return -1;
 
-		if (--ch < 0)
-			break;
-
-		if ((unsigned char)(ptr[ch] - '0') <= 9)
-			bytes[byte] |= (ptr[ch] - '0') << 4;
-		else if (ptr[ch] >= 'A' && ptr[ch] <= 'F')
-			bytes[byte] |= (ptr[ch] - '7') << 4;
-		else if (ptr[ch] >= 'a' && ptr[ch] <= 'f')
-			bytes[byte] |= (ptr[ch] - 'W') << 4;
-		else
-			throw - 1;
+		bytes[len / 2] = digit;
 	}
+
+	return hex_decode(bytes, ptr, len / 2);
 }
 
 // Constructs a Big Integer of N bytes from a base 64 big endian string format of the number.
-// If the format is invalid, an exception is thrown. If too many digits are present, they are ignored.
+// If the format is invalid, -1 is returned, otherwise 0. If too many digits are present, they are ignored.
 // The function first identifies the number of padding characters (=) to adjust the location and
 // value of the least significant digit. The value of digits are found from a lookup table where
 // the ascii value of the character is the index to the values. The 6 bit values are shifter
 // to the right position (<<) and added to the bytes (|=) one by one. 
 template <unsigned int N>
-void BigInt<N>::base64(const cstr num)
+int BigInt<N>::base64(const char* num, int nlen)
 {
-	int nlen = strlen(num);
 	int padding = 0;
 	memset(bytes, 0, N);
 
 	if (nlen == 0)
-		return;
+		return 0;
 
 	if (nlen <3)
-		throw - 1;
+		return -1;
 
 	if (num[nlen - 1] == '=')
 	{	padding++;
@@ -194,16 +139,16 @@ void BigInt<N>::base64(const cstr num)
 	short digit;
 	int   shift = 6 - (padding << 1);
 
-	if (v64[num[nlen - 1]] == -1)
-		throw - 1;
+	if (v64[(unsigned char)num[nlen - 1]] == -1)
+		return -1;
 
-	bytes[0] = v64[num[nlen - 1]] >> (2 * padding);
+	bytes[0] = v64[(unsigned char)num[nlen - 1]] >> (2 * padding);
 
 	for (int ch = nlen - 2, byte = 0; ch >= 0 && byte<N; ch--)
 	{
 		digit = v64[(unsigned char)num[ch]];
 		if (digit == -1)
-			throw - 1;
+			return -1;
 
 		digit <<= shift;
 		bytes[byte] |= *(char*)&digit;
@@ -216,6 +161,7 @@ void BigInt<N>::base64(const cstr num)
 		if (shift >= 8)
 			shift -= 8;
 	}
+	return 0;
 }
 
 // Constructs a Big Integer of N bytes, all set to 0.
@@ -279,14 +225,30 @@ BigInt<N>& BigInt<N>::operator=(const BigInt<N> &other)
 	return *this;
 }
 
-// Constructs a Big Integer of N bytes using a string format of the number and a base.
-// The constructor accepts formats in different bases, 2, 8, 10, 16, 64.
-// If the format or the base is invalid, an exception is thrown.
+// Parses len characters of a string format of the number into a Big Integer of N bytes,
+// without allocations. The formats in different bases, 2, 8, 10, 16, 64 are accepted.
+// If the base is 0, it is taken from the prefix like the constructor from a string does,
+// otherwise a leading 0 and the base character after it are skipped.
+// If the format or the base is invalid, -1 is returned, otherwise 0.
 template <unsigned int N>
-BigInt<N>::BigInt(const cstr num, const int base)
+int BigInt<N>::fromChars(const char* num, int len, int base)
 {
 	int prefix = 0;
-	int len = strlen(num);
+
+	if (base == 0)
+	{
+		if (len > 1 && num[0] == '0' && (num[1] == 'b' || num[1] == 'B'))
+			return base2(num + 2, len - 2);
+		else if (len > 1 && num[0] == '0' && (num[1] == 'x' || num[1] == 'X'))
+			return base16(num + 2, len - 2);
+		else if (len > 1 && num[0] == '0' && num[1] == '#')
+			return base64(num + 2, len - 2);
+		else if (len > 0 && num[0] == '0')
+			return base8(num + 1, len - 1);
+		else
+			return base10(num, len);
+	}
+
 	if (len > 0 && num[0] == '0')
 	{
 		if (len > 1 && (num[1] == 'x' || num[1] == '#' || num[1] == 'b'))
@@ -294,22 +256,25 @@ BigInt<N>::BigInt(const cstr num, const int base)
 		prefix++;
 	}
 
-	try
+	switch (base)
 	{
-		switch (base)
-		{
-		case 2:  base2(num + prefix); break;
-		case 8:  base8(num + prefix); break;
-		case 10: base10(num + prefix); break;
-		case 16: base16(num + prefix); break;
-		case 64: base64(num + prefix); break;
-		default: throw - 1;
-		}
+	case 2:  return base2(num + prefix, len - prefix);
+	case 8:  return base8(num + prefix, len - prefix);
+	case 10: return base10(num + prefix, len - prefix);
+	case 16: return base16(num + prefix, len - prefix);
+	case 64: return base64(num + prefix, len - prefix);
+	default: return -1;
 	}
-	catch (int)
-	{
+}
+
+// Constructs a Big Integer of N bytes using a string format of the number and a base.
+// The constructor accepts formats in different bases, 2, 8, 10, 16, 64.
+// If the format or the base is invalid, an exception is thrown.
+template <unsigned int N>
+BigInt<N>::BigInt(const cstr num, const int base)
+{
+	if (base == 0 || fromChars(num, strlen(num), base))
 		throw - 1;
-	}
 }
 
 // Constructs a Big Integer of N bytes using a string format of the number.
@@ -321,23 +286,6 @@ BigInt<N>::BigInt(const cstr num, const int base)
 template <unsigned int N>
 BigInt<N>::BigInt(const cstr num)
 {
-	int len = strlen(num);
-
-	try
-	{
-		if (len > 1 && num[0] == '0' && (num[1] == 'b' || num[1] == 'B'))
-			base2(num + 2);
-		else if (len > 1 && num[0] == '0' && (num[1] == 'x' || num[1] == 'X'))
-			base16(num + 2);
-		else if (len > 1 && num[0] == '0' && num[1] == '#')
-			base64(num + 2);
-		else if (len > 0 && num[0] == '0')
-			base8(num + 1);
-		else
-			base10(num);
-	}
-	catch (int)
-	{
+	if (fromChars(num, strlen(num)))
 		throw - 1;
-	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,79 @@
+//----------------------------------------------------------------------------//
+//                                Division Kernels                            //
+//--------------------------------------------------------------------------- //
+
+// Divides len limbs of a by the limb d. The quotient is written to q, which can be a,
+// and the remainder is returned.
+static limb limb_divmod_1(limb* q, const limb* a, int len, limb d)
+{
+	limb rem = 0;
+	for (int i = len - 1; i >= 0; i--)
+	{	q[i] = limb_div(rem, a[i], d, rem);
+	}
+	return rem;
+}
+
+// Divides na limbs of a by nb limbs of b with Knuth's algorithm D, where na >= nb and
+// the most significant limb of b is not 0. The quotient (na-nb+1 limbs) is written to q
+// and the remainder (nb limbs) to r. The scratch memory must hold na+nb+1 limbs.
+// [1] The operands are shifted so the top bit of b is set, which makes the estimate of
+//     each quotient limb from the top two limbs of the remainder at most 2 too large.
+// [2] The estimate is corrected with the second limb of b, which leaves it at most 1 too large,
+//     then it multiplies b and is subtracted. If that borrows, b is added back once.
+// [3] The remainder is shifted back.
+static void limb_divmod(limb* q, limb* r, const limb* a, int na, const limb* b, int nb, limb* scratch)
+{
+	if (nb == 1)
+	{	r[0] = limb_divmod_1(q, a, na, b[0]);
+		return;
+	}
+
+// [1]
+	int   bits = limb_clz(b[nb - 1]);
+	limb* u = scratch;
+	limb* v = scratch + na + 1;
+
+	limb_shl(v, b, nb, bits);
+	u[na] = limb_shl(u, a, na, bits);
+
+// [2]
+	for (int j = na - nb; j >= 0; j--)
+	{
+		limb qhat, rhat, hi, lo;
+		bool test = true;
+
+		if (u[j + nb] >= v[nb - 1])
+		{	qhat = ~(limb)0;
+			rhat = u[j + nb - 1] + v[nb - 1];
+			test = rhat >= v[nb - 1];
+		}
+		else
+		{	qhat = limb_div(u[j + nb], u[j + nb - 1], v[nb - 1], rhat);
+		}
+
+		while (test)
+		{
+			lo = limb_mac(qhat, v[nb - 2], 0, 0, hi);
+			if (hi < rhat || (hi == rhat && lo <= u[j + nb - 2]))
+				break;
+
+			qhat--;
+			rhat += v[nb - 1];
+			test = rhat >= v[nb - 1];
+		}
+
+		limb borrow = limb_submul(u + j, v, nb, qhat);
+		limb top = u[j + nb];
+		u[j + nb] = top - borrow;
+
+		if (top < borrow)
+		{	qhat--;
+			u[j + nb] += limb_add(u + j, v, nb);
+		}
+
+		q[j] = qhat;
+	}
+
+// [3]
+	limb_shr(r, u, nb, bits);
+}
@@ -0,0 +1,248 @@
+//----------------------------------------------------------------------------//
+//                                Limb Primitives                             //
+//--------------------------------------------------------------------------- //
+
+// Machine word (limb) used by the multiplication and reduction kernels.
+// The bytes of a Big Integer are in little endian order, so N bytes can be
+// processed as N / sizeof(limb) limbs, least significant limb first.
+#if defined(_X64)
+typedef unsigned long long limb;
+#else
+typedef unsigned int limb;
+#endif
+
+#define LIMB_BITS (sizeof(limb) * 8)
+
+// Multiplies two limbs and adds a third limb and a carry to the product.
+// The low limb of the result is returned and the high limb is written to hi.
+// The result can not overflow: (2^w-1)^2 + 2(2^w-1) = 2^2w - 1
+static inline limb limb_mac(limb a, limb b, limb c, limb carry, limb &hi)
+{
+#if defined(_MSVC_INTEL) && defined(_X64)
+	limb h;
+	limb l = _umul128(a, b, &h);
+	h += _addcarry_u64(0, l, c, &l);
+	h += _addcarry_u64(0, l, carry, &l);
+	hi = h;
+	return l;
+#elif defined(_GAS_ATT) && defined(_X64)
+	unsigned __int128 p = (unsigned __int128)a * b + c + carry;
+	hi = (limb)(p >> 64);
+	return (limb)p;
+#else
+	unsigned long long p = (unsigned long long)a * b + c + carry;
+	hi = (limb)(p >> 32);
+	return (limb)p;
+#endif
+}
+
+// Multiplies len limbs of a by the limb b and adds the product to len limbs of r.
+// The carry out of the most significant limb is returned.
+static inline limb limb_addmul(limb* r, const limb* a, int len, limb b)
+{
+	limb carry = 0;
+	for (int i = 0; i < len; i++)
+	{	r[i] = limb_mac(a[i], b, r[i], carry, carry);
+	}
+	return carry;
+}
+
+// Finds the inverse of an odd limb modulo 2^w with Newton iterations.
+// x = a is correct to 3 bits for odd a, and every iteration doubles the correct bits.
+static inline limb limb_inverse(limb a)
+{
+	limb x = a;
+	for (int bits = 3; bits < (int)LIMB_BITS; bits <<= 1)
+	{	x *= 2 - a * x;
+	}
+	return x;
+}
+
+// Adds len limbs of a to len limbs of r. The carry out of the most significant limb is returned.
+static inline limb limb_add(limb* r, const limb* a, int len)
+{
+	limb carry = 0;
+	for (int i = 0; i < len; i++)
+	{	limb s = r[i] + carry;
+		carry  = s < carry;
+		r[i]   = s + a[i];
+		carry += r[i] < s;
+	}
+	return carry;
+}
+
+// Subtracts len limbs of a from len limbs of r. The borrow out of the most significant limb is returned.
+static inline limb limb_sub(limb* r, const limb* a, int len)
+{
+	limb borrow = 0;
+	for (int i = 0; i < len; i++)
+	{	limb s  = a[i] + borrow;
+		borrow  = s < borrow;
+		borrow += r[i] < s;
+		r[i]   -= s;
+	}
+	return borrow;
+}
+
+// Adds a carry to len limbs of r, stopping as soon as there is nothing left to carry.
+// The carry out of the most significant limb is returned.
+static inline limb limb_inc(limb* r, int len, limb carry)
+{
+	for (int i = 0; i < len && carry; i++)
+	{	r[i] += carry;
+		carry = r[i] < carry;
+	}
+	return carry;
+}
+
+// Subtracts a borrow from len limbs of r, stopping as soon as there is nothing left to borrow.
+// The borrow out of the most significant limb is returned.
+static inline limb limb_dec(limb* r, int len, limb borrow)
+{
+	for (int i = 0; i < len && borrow; i++)
+	{	limb s = r[i];
+		r[i]   = s - borrow;
+		borrow = s < borrow;
+	}
+	return borrow;
+}
+
+// Finds the number of limbs needed to represent a number of len limbs,
+// without the leading 0 limbs. Returns 0 if the number is 0.
+static inline int limb_length(const limb* a, int len)
+{
+	while (len > 0 && a[len - 1] == 0)
+	{	len--;
+	}
+	return len;
+}
+
+// Compares len limbs of a with len limbs of b from the most significant limb.
+// Returns 1 if a is greater, -1 if it is less and 0 if they are equal.
+static inline int limb_cmp(const limb* a, const limb* b, int len)
+{
+	for (int i = len - 1; i >= 0; i--)
+	{	if (a[i] != b[i])
+			return a[i] > b[i] ? 1 : -1;
+	}
+	return 0;
+}
+
+// Multiplies len limbs of a by the limb b and subtracts the product from len limbs of r.
+// The borrow out of the most significant limb is returned.
+static inline limb limb_submul(limb* r, const limb* a, int len, limb b)
+{
+	limb carry = 0, hi;
+	for (int i = 0; i < len; i++)
+	{	limb lo = limb_mac(a[i], b, carry, 0, hi);
+		limb t  = r[i];
+		r[i]    = t - lo;
+		carry   = hi + (t < lo);
+	}
+	return carry;
+}
+
+// Divides len limbs of a by 3 into r, which can be a, when a is known to be a multiple of 3.
+// Each limb is multiplied by the inverse of 3 modulo 2^w instead of divided, and the high
+// limb of 3 times the quotient limb is borrowed from the next limb.
+static inline void limb_divexact_3(limb* r, const limb* a, int len)
+{
+	const limb inverse = (limb)~(limb)0 / 3 * 2 + 1;
+	limb borrow = 0, hi;
+	for (int i = 0; i < len; i++)
+	{	limb s = a[i] - borrow;
+		limb b = a[i] < borrow;
+		r[i]   = s * inverse;
+		limb_mac(r[i], 3, 0, 0, hi);
+		borrow = hi + b;
+	}
+}
+
+// Divides the two limb number (hi, lo) by d, where hi must be less than d.
+// The quotient is returned and the remainder is written to rem.
+static inline limb limb_div(limb hi, limb lo, limb d, limb &rem)
+{
+#if defined(_MSVC_INTEL) && defined(_X64)
+	return _udiv128(hi, lo, d, &rem);
+#elif defined(_GAS_ATT) && defined(_X64)
+	limb q, r;
+	__asm__("divq %4" : "=a" (q), "=d" (r) : "0" (lo), "1" (hi), "rm" (d));
+	rem = r;
+	return q;
+#else
+	unsigned long long n = ((unsigned long long)hi << 32) | lo;
+	rem = (limb)(n % d);
+	return (limb)(n / d);
+#endif
+}
+
+// Counts the leading 0 bits of a limb that is not 0
+static inline int limb_clz(limb a)
+{
+#if defined(_MSVC_INTEL) && defined(_X64)
+	unsigned long i;
+	_BitScanReverse64(&i, a);
+	return 63 - i;
+#elif defined(_MSVC_INTEL)
+	unsigned long i;
+	_BitScanReverse(&i, a);
+	return 31 - i;
+#elif defined(_X64)
+	return __builtin_clzll(a);
+#else
+	return __builtin_clz(a);
+#endif
+}
+
+// Counts the trailing 0 bits of a limb that is not 0.
+// The builtins compile to TZCNT and the ones above to LZCNT when the target has them.
+static inline int limb_ctz(limb a)
+{
+#if defined(_MSVC_INTEL) && defined(_X64)
+	unsigned long i;
+	_BitScanForward64(&i, a);
+	return i;
+#elif defined(_MSVC_INTEL)
+	unsigned long i;
+	_BitScanForward(&i, a);
+	return i;
+#elif defined(_X64)
+	return __builtin_ctzll(a);
+#else
+	return __builtin_ctz(a);
+#endif
+}
+
+// Shifts len limbs of a to the left by 0 to LIMB_BITS-1 bits into r, which can be a.
+// The bits shifted out of the most significant limb are returned.
+static inline limb limb_shl(limb* r, const limb* a, int len, int bits)
+{
+	if (bits == 0)
+	{	memmove(r, a, len * sizeof(limb));
+		return 0;
+	}
+
+	limb out = a[len - 1] >> (LIMB_BITS - bits);
+	for (int i = len - 1; i > 0; i--)
+	{	r[i] = (a[i] << bits) | (a[i - 1] >> (LIMB_BITS - bits));
+	}
+	r[0] = a[0] << bits;
+	return out;
+}
+
+// Shifts len limbs of a to the right by 0 to LIMB_BITS-1 bits into r, which can be a.
+// The bits shifted out of the least significant limb are returned in the high bits.
+static inline limb limb_shr(limb* r, const limb* a, int len, int bits)
+{
+	if (bits == 0)
+	{	memmove(r, a, len * sizeof(limb));
+		return 0;
+	}
+
+	limb out = a[0] << (LIMB_BITS - bits);
+	for (int i = 0; i < len - 1; i++)
+	{	r[i] = (a[i] >> bits) | (a[i + 1] << (LIMB_BITS - bits));
+	}
+	r[len - 1] = a[len - 1] >> bits;
+	return out;
+}
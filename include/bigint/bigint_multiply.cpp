@@ -0,0 +1,368 @@
+//----------------------------------------------------------------------------//
+//                             Multiplication Kernels                         //
+//--------------------------------------------------------------------------- //
+
+// Number of limbs at and below which multiplication is done with the schoolbook method.
+// Karatsuba saves a quarter of the multiplications per level, but the additions and copies
+// around them cost more than that on small operands. The best value depends on the CPU,
+// tools/calibrate.cpp measures it and prints the definition for the host.
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 24
+#endif
+
+// Number of limbs at and below which squaring is done with the schoolbook method.
+// The schoolbook square only calculates half of the products, so it stays ahead for longer.
+#ifndef BIGINT_KARATSUBA_SQR_THRESHOLD
+#define BIGINT_KARATSUBA_SQR_THRESHOLD 40
+#endif
+
+// Number of limbs above which multiplication is done with Toom-3 instead of Karatsuba.
+// Toom-3 needs 5 multiplications of a third of the length where Karatsuba needs 9 of them
+// over two levels, but its evaluation and interpolation pass over the operands a dozen times.
+// Between 96 and 256 limbs the two are within a few percent of each other, and
+// tools/calibrate.cpp puts the crossover of multiplication at 112 to 128 limbs on x64.
+// So the 128 limb products of 8192 bit keys are done with Toom-3, 4096 bit keys stay on Karatsuba.
+#ifndef BIGINT_TOOM3_THRESHOLD
+#define BIGINT_TOOM3_THRESHOLD 112
+#endif
+
+// Number of limbs above which squaring is done with Toom-3 instead of Karatsuba.
+// The Karatsuba square saves more against its products, calibrate measures 80 to 160 limbs.
+#ifndef BIGINT_TOOM3_SQR_THRESHOLD
+#define BIGINT_TOOM3_SQR_THRESHOLD 128
+#endif
+
+// Finds an upper bound of the scratch limbs limb_mul and limb_sqr need for operands of
+// at most len limbs. A level of Karatsuba or a row of blocks uses less than 2*len+6 limbs,
+// and hands the rest to operands of at most len/2+1 limbs. A level of Toom-3 uses less
+// than 4*len+24 limbs, and hands the rest to operands of at most len/3+2 limbs.
+static inline int limb_mul_scratch(int len)
+{
+	int size = 0;
+	while (len >= 4 && len > (BIGINT_KARATSUBA_THRESHOLD < BIGINT_KARATSUBA_SQR_THRESHOLD ? BIGINT_KARATSUBA_THRESHOLD : BIGINT_KARATSUBA_SQR_THRESHOLD))
+	{	size += len > (BIGINT_TOOM3_THRESHOLD < BIGINT_TOOM3_SQR_THRESHOLD ? BIGINT_TOOM3_THRESHOLD : BIGINT_TOOM3_SQR_THRESHOLD) ? len * 4 + 24 : len * 2 + 6;
+		len = (len + 1) / 2 + 1;
+	}
+	return size;
+}
+
+// Multiplies na limbs of a by nb limbs of b into na+nb limbs of r with the schoolbook method.
+// Each limb of b multiplies a, and the row is added to the result one limb further up.
+// The result must not overlap the operands.
+static void limb_mul_basecase(limb* r, const limb* a, int na, const limb* b, int nb)
+{
+	memset(r, 0, na * sizeof(limb));
+	for (int i = 0; i < nb; i++)
+	{	r[i + na] = limb_addmul(r + i, a, na, b[i]);
+	}
+}
+
+// Squares len limbs of a into 2*len limbs of r with the schoolbook method.
+// Every product a[i]*a[j] with i<j is calculated once, then the sum is doubled
+// and the squares a[i]*a[i] are added in a single pass. The result must not overlap a.
+static void limb_sqr_basecase(limb* r, const limb* a, int len)
+{
+	memset(r, 0, len * 2 * sizeof(limb));
+	for (int i = 0; i < len - 1; i++)
+	{	r[i + len] = limb_addmul(r + i + i + 1, a + i + 1, len - i - 1, a[i]);
+	}
+
+	limb carry = 0, hi;
+	for (int i = 0; i < len; i++)
+	{
+		limb lo = limb_mac(a[i], a[i], 0, 0, hi);
+		r[i + i]     = limb_mac(r[i + i], 2, lo, carry, carry);
+		r[i + i + 1] = limb_mac(r[i + i + 1], 2, hi, carry, carry);
+	}
+}
+
+static void limb_mul(limb* r, const limb* a, int na, const limb* b, int nb, limb* scratch);
+static void limb_sqr(limb* r, const limb* a, int len, limb* scratch);
+
+// Multiplies na limbs of a by nb limbs of b into na+nb limbs of r with one level of Karatsuba.
+// The operands are split at h = na/2 rounded up, where b must have more than h limbs.
+// (A0+A1) and (B0+B1) keep their carry in an extra limb, so Z1 is a multiplication of h+1 limbs.
+// Z0=A0*B0 and Z2=A1*B1 are calculated in place in the result, and subtracted from Z1
+// which is then added to the middle of the result.
+static void limb_mul_karatsuba(limb* r, const limb* a, int na, const limb* b, int nb, limb* scratch)
+{
+	int h = (na + 1) / 2;
+	limb* sa = scratch;
+	limb* sb = sa + h + 1;
+	limb* z1 = sb + h + 1;
+	limb* next = z1 + h * 2 + 2;
+
+	//(A0+A1) and (B0+B1)
+	memcpy(sa, a, h * sizeof(limb));
+	sa[h] = limb_inc(sa + na - h, h + h - na, limb_add(sa, a + h, na - h));
+	memcpy(sb, b, h * sizeof(limb));
+	sb[h] = limb_inc(sb + nb - h, h + h - nb, limb_add(sb, b + h, nb - h));
+
+	//(A0+A1) * (B0+B1)
+	limb_mul(z1, sa, h + 1, sb, h + 1, next);
+
+	// Z0=A0*B0 and Z2=A1*B1 in the result
+	limb_mul(r, a, h, b, h, next);
+	limb_mul(r + h * 2, a + h, na - h, b + h, nb - h, next);
+
+	// Z1 - Z0 - Z2
+	limb_dec(z1 + h * 2, 2, limb_sub(z1, r, h * 2));
+	limb_dec(z1 + na + nb - h * 2, h * 4 + 2 - na - nb, limb_sub(z1, r + h * 2, na + nb - h * 2));
+
+	// Result Z2 + Z1 + Z0 (shift adjusted), the limbs of Z1 above the result are 0
+	int len = (h * 2 + 2 < na + nb - h) ? h * 2 + 2 : na + nb - h;
+	limb_inc(r + h + len, na + nb - h - len, limb_add(r + h, z1, len));
+}
+
+// Squares len limbs of a into 2*len limbs of r with one level of Karatsuba.
+// The operand is split at h = len/2 rounded up. (A0+A1) keeps its carry in an extra limb,
+// A0^2 and A1^2 are calculated in place in the result, and subtracted from (A0+A1)^2
+// which is then added to the middle of the result.
+static void limb_sqr_karatsuba(limb* r, const limb* a, int len, limb* scratch)
+{
+	int h = (len + 1) / 2;
+	limb* sa = scratch;
+	limb* z1 = sa + h + 1;
+	limb* next = z1 + h * 2 + 2;
+
+	//(A0+A1)
+	memcpy(sa, a, h * sizeof(limb));
+	sa[h] = limb_inc(sa + len - h, h + h - len, limb_add(sa, a + h, len - h));
+
+	//(A0+A1)^2
+	limb_sqr(z1, sa, h + 1, next);
+
+	// Z0=A0^2 and Z2=A1^2 in the result
+	limb_sqr(r, a, h, next);
+	limb_sqr(r + h * 2, a + h, len - h, next);
+
+	// Z1 - Z0 - Z2
+	limb_dec(z1 + h * 2, 2, limb_sub(z1, r, h * 2));
+	limb_dec(z1 + (len - h) * 2, h * 4 + 2 - len * 2, limb_sub(z1, r + h * 2, (len - h) * 2));
+
+	// Result Z2 + Z1 + Z0 (shift adjusted), the limbs of Z1 above the result are 0
+	int add = (h * 2 + 2 < len * 2 - h) ? h * 2 + 2 : len * 2 - h;
+	limb_inc(r + h + add, len * 2 - h - add, limb_add(r + h, z1, add));
+}
+
+// Evaluates an operand of Toom-3, split into x0, x1 (k limbs each) and x2 (len limbs), at 1
+// into p and at -1 into m, k+1 limbs each. x(-1) can be negative, so m holds its magnitude
+// and true is returned for a negative value.
+static bool limb_toom3_eval(limb* p, limb* m, const limb* x, int k, int len)
+{
+	const limb* x1 = x + k;
+
+	// x0 + x2
+	memcpy(p, x, k * sizeof(limb));
+	p[k] = limb_inc(p + len, k - len, limb_add(p, x + k * 2, len));
+
+	// x0 - x1 + x2
+	bool negative = p[k] == 0 && limb_cmp(p, x1, k) < 0;
+	if (negative)
+	{	memcpy(m, x1, k * sizeof(limb));
+		m[k] = 0;
+		limb_sub(m, p, k);
+	}
+	else
+	{	memcpy(m, p, (k + 1) * sizeof(limb));
+		m[k] -= limb_sub(m, x1, k);
+	}
+
+	// x0 + x1 + x2
+	p[k] += limb_add(p, x1, k);
+	return negative;
+}
+
+// Evaluates an operand of Toom-3 at 2 into p of k+1 limbs, as x0 + 2 * (x1 + 2 * x2) with
+// the inner sum in t of k+1 limbs.
+static void limb_toom3_eval2(limb* p, limb* t, const limb* x, int k, int len)
+{
+	memcpy(t, x + k, k * sizeof(limb));
+	t[k] = 0;
+	limb_inc(t + len, k + 1 - len, limb_addmul(t, x + k * 2, len, 2));
+
+	memcpy(p, x, k * sizeof(limb));
+	p[k] = 0;
+	limb_addmul(p, t, k + 1, 2);
+}
+
+// Interpolates the product of Toom-3 from its values at 0, 1, -1, 2 and infinity, and adds
+// the coefficients r1, r2 and r3 into total limbs of r at k, 2k and 3k limbs. v0 = r0 must be
+// in the lowest 2k limbs of r and vinf = r4 in the limbs from 4k. v1, vm1 = |v(-1)| and v2
+// take 2k+2 limbs, as does t, and all of them are overwritten. The coefficients are found as
+//   r1 + r3 = (v1 - v(-1)) / 2,   r2 = (v1 + v(-1)) / 2 - v0 - vinf,
+//   r3 = ((v2 - v0 - 16 vinf) / 2 - (r1 + r3) - 2 r2) / 3,   r1 = (r1 + r3) - r3
+// and in this order no step goes below 0, so only v(-1) needs a sign.
+static void limb_toom3_interpolate(limb* r, int total, int k, limb* v1, limb* vm1, bool negative, limb* v2, limb* t)
+{
+	const int n  = k * 2 + 2;
+	const int n4 = total - k * 4;
+	const limb* v0   = r;
+	const limb* vinf = r + k * 4;
+
+	// r1 + r3 in t, r0 + r2 + r4 in v1
+	memcpy(t, v1, n * sizeof(limb));
+	if (negative)
+	{	limb_add(t, vm1, n);
+		limb_sub(v1, vm1, n);
+	}
+	else
+	{	limb_sub(t, vm1, n);
+		limb_add(v1, vm1, n);
+	}
+	limb_shr(t, t, n, 1);
+	limb_shr(v1, v1, n, 1);
+
+	// r2 in v1
+	limb_dec(v1 + k * 2, n - k * 2, limb_sub(v1, v0, k * 2));
+	limb_dec(v1 + n4, n - n4, limb_sub(v1, vinf, n4));
+
+	// r3 in v2
+	limb_dec(v2 + k * 2, n - k * 2, limb_sub(v2, v0, k * 2));
+	limb_dec(v2 + n4, n - n4, limb_submul(v2, vinf, n4, 16));
+	limb_shr(v2, v2, n, 1);
+	limb_sub(v2, t, n);
+	limb_submul(v2, v1, n, 2);
+	limb_divexact_3(v2, v2, n);
+
+	// r1 in t
+	limb_sub(t, v2, n);
+
+	// Result r4 + r3 + r2 + r1 + r0 (shift adjusted), the limbs of the coefficients above the result are 0
+	memset(r + k * 2, 0, k * 2 * sizeof(limb));
+
+	limb* parts[3] = { t, v1, v2 };
+	for (int i = 0; i < 3; i++)
+	{	int off = k * (i + 1);
+		int len = (n < total - off) ? n : total - off;
+		limb_inc(r + off + len, total - off - len, limb_add(r + off, parts[i], len));
+	}
+}
+
+// Multiplies na limbs of a by nb limbs of b into na+nb limbs of r with one level of Toom-3.
+// The operands are split into three parts at k = na/3 rounded up, where b must have more than
+// 2k limbs. The parts are the coefficients of polynomials of degree 2, which are evaluated at
+// 0, 1, -1, 2 and infinity and multiplied there: 5 multiplications of about k limbs, where the
+// schoolbook method needs 9. The product polynomial is interpolated from the 5 values.
+// v0 = A0*B0 and vinf = A2*B2 are calculated in place in the result.
+static void limb_mul_toom3(limb* r, const limb* a, int na, const limb* b, int nb, limb* scratch)
+{
+	int k  = (na + 2) / 3;
+	int la = na - k * 2;
+	int lb = nb - k * 2;
+
+	limb* pa   = scratch;
+	limb* pb   = pa + k + 1;
+	limb* ma   = pb + k + 1;
+	limb* mb   = ma + k + 1;
+	limb* v1   = mb + k + 1;
+	limb* vm1  = v1 + k * 2 + 2;
+	limb* v2   = vm1 + k * 2 + 2;
+	limb* t    = v2 + k * 2 + 2;
+	limb* next = t + k * 2 + 2;
+
+	// A(1)*B(1) and A(-1)*B(-1)
+	bool negative = limb_toom3_eval(pa, ma, a, k, la) != limb_toom3_eval(pb, mb, b, k, lb);
+	limb_mul(v1, pa, k + 1, pb, k + 1, next);
+	limb_mul(vm1, ma, k + 1, mb, k + 1, next);
+
+	// A(2)*B(2)
+	limb_toom3_eval2(pa, t, a, k, la);
+	limb_toom3_eval2(pb, t, b, k, lb);
+	limb_mul(v2, pa, k + 1, pb, k + 1, next);
+
+	// A(0)*B(0) and A(inf)*B(inf) in the result
+	limb_mul(r, a, k, b, k, next);
+	limb_mul(r + k * 4, a + k * 2, la, b + k * 2, lb, next);
+
+	limb_toom3_interpolate(r, na + nb, k, v1, vm1, negative, v2, t);
+}
+
+// Squares len limbs of a into 2*len limbs of r with one level of Toom-3.
+// Works the same way as limb_mul_toom3 with 5 squares, A(-1)^2 is never negative.
+static void limb_sqr_toom3(limb* r, const limb* a, int len, limb* scratch)
+{
+	int k  = (len + 2) / 3;
+	int la = len - k * 2;
+
+	limb* pa   = scratch;
+	limb* ma   = pa + k + 1;
+	limb* v1   = ma + k + 1;
+	limb* vm1  = v1 + k * 2 + 2;
+	limb* v2   = vm1 + k * 2 + 2;
+	limb* t    = v2 + k * 2 + 2;
+	limb* next = t + k * 2 + 2;
+
+	// A(1)^2 and A(-1)^2
+	limb_toom3_eval(pa, ma, a, k, la);
+	limb_sqr(v1, pa, k + 1, next);
+	limb_sqr(vm1, ma, k + 1, next);
+
+	// A(2)^2
+	limb_toom3_eval2(pa, t, a, k, la);
+	limb_sqr(v2, pa, k + 1, next);
+
+	// A(0)^2 and A(inf)^2 in the result
+	limb_sqr(r, a, k, next);
+	limb_sqr(r + k * 4, a + k * 2, la, next);
+
+	limb_toom3_interpolate(r, len * 2, k, v1, vm1, false, v2, t);
+}
+
+// Multiplies na limbs of a by nb limbs of b into na+nb limbs of r. The result must not
+// overlap the operands, and the scratch memory must hold limb_mul_scratch(max(na, nb)) limbs.
+// The kernel is chosen from the actual lengths of the operands:
+// - The schoolbook method if the shorter operand is at or below the threshold
+// - Toom-3 above its threshold, if the shorter operand has more than 2/3 of the longer one
+// - Karatsuba if the operands are of similar length
+// - Otherwise the longer operand is split into blocks of the length of the shorter one,
+//   each block is multiplied on its own and the products are added at their offsets.
+static void limb_mul(limb* r, const limb* a, int na, const limb* b, int nb, limb* scratch)
+{
+	if (na < nb)
+	{	const limb* t = a; a = b; b = t;
+		int n = na; na = nb; nb = n;
+	}
+
+	if (nb == 0)
+	{	memset(r, 0, na * sizeof(limb));
+		return;
+	}
+	if (nb < 4 || nb <= BIGINT_KARATSUBA_THRESHOLD)
+	{	limb_mul_basecase(r, a, na, b, nb);
+		return;
+	}
+	if (nb > BIGINT_TOOM3_THRESHOLD && nb > (na + 2) / 3 * 2)
+	{	limb_mul_toom3(r, a, na, b, nb, scratch);
+		return;
+	}
+	if (nb > (na + 1) / 2)
+	{	limb_mul_karatsuba(r, a, na, b, nb, scratch);
+		return;
+	}
+
+	limb* t = scratch;
+	limb* next = scratch + nb * 2;
+
+	limb_mul(r, a, nb, b, nb, next);
+	memset(r + nb * 2, 0, (na - nb) * sizeof(limb));
+
+	for (int i = nb; i < na; i += nb)
+	{
+		int len = (na - i < nb) ? na - i : nb;
+		limb_mul(t, a + i, len, b, nb, next);
+		limb_inc(r + i + len + nb, na - i - len, limb_add(r + i, t, len + nb));
+	}
+}
+
+// Squares len limbs of a into 2*len limbs of r. The result must not overlap the operand,
+// and the scratch memory must hold limb_mul_scratch(len) limbs.
+static void limb_sqr(limb* r, const limb* a, int len, limb* scratch)
+{
+	if (len < 4 || len <= BIGINT_KARATSUBA_SQR_THRESHOLD)
+		limb_sqr_basecase(r, a, len);
+	else if (len > BIGINT_TOOM3_SQR_THRESHOLD)
+		limb_sqr_toom3(r, a, len, scratch);
+	else
+		limb_sqr_karatsuba(r, a, len, scratch);
+}
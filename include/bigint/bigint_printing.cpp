@@ -15,214 +15,199 @@ int BigInt<N>::length() const
 }
 
 
-// Constructs a string of big endian order binary digits from the value of
-// an N byte long Big Integer. The result ignores leading 0s.
-// An array of digits is initialized to '0', then for all valid bytes,
-// each bit is extracted using & and shift, then added to the '0'.
-// Leading zeros are removed from the string, and if all digits were removed,
-// "0" is returned as a special case.
+// Writes the big endian order binary digits of an N byte long Big Integer into a buffer
+// of at least N*8 characters, without a terminating 0. The result ignores leading 0s.
+// The top byte is written from its highest set bit one bit at a time, the rest of the bytes
+// 8 digits at a time (see bin_encode). The number of digits written is returned, 0 is written as "0".
 template <unsigned int N>
-str BigInt<N>::str2() const
+int BigInt<N>::chars2(char* buf) const
 {
-	int   digitCtr = 0;
-	char  digitRaw[N * 8 + 1];
-	char* digitStart = digitRaw;
-	memset(digitRaw, '0', N * 8);
+	int   len = length();
+	char* end = buf;
 
-	for (int i = length() - 1; i >= 0; i--)
-	{
-		digitRaw[digitCtr++] += (bytes[i] & 128) >> 7;
-		digitRaw[digitCtr++] += (bytes[i] & 64) >> 6;
-		digitRaw[digitCtr++] += (bytes[i] & 32) >> 5;
-		digitRaw[digitCtr++] += (bytes[i] & 16) >> 4;
-		digitRaw[digitCtr++] += (bytes[i] & 8) >> 3;
-		digitRaw[digitCtr++] += (bytes[i] & 4) >> 2;
-		digitRaw[digitCtr++] += (bytes[i] & 2) >> 1;
-		digitRaw[digitCtr++] += (bytes[i] & 1);
+	if (len == 0)
+	{	buf[0] = '0';
+		return 1;
 	}
 
-	digitRaw[digitCtr] = 0;
-	while (digitStart[0] == '0')
-		digitStart++;
+	int bit = 7;
+	while (!(bytes[len - 1] >> bit))
+		bit--;
 
-	if (digitStart[0] == 0)
-		return "0";
-	else
-		return str(digitStart);
+	for (; bit >= 0; bit--)
+		*end++ = '0' + ((bytes[len - 1] >> bit) & 1);
+
+	end = bin_encode(end, bytes, len - 1);
+	return (int)(end - buf);
 }
 
-//STUB
+// Writes the big endian order octal digits of an N byte long Big Integer into a buffer
+// of at least (N*8+2)/3 characters, without a terminating 0. The result ignores leading 0s.
+// 3 bytes are exactly 8 octal digits, so the bytes are collected into 24 bits 3 at a time
+// from the bottom, and each group is written as 8 digits right to left, until all digits are written.
+// The number of digits written is returned, 0 is written as "0".
 template <unsigned int N>
-str BigInt<N>::str8() const
+int BigInt<N>::chars8(char* buf) const
 {
-	char  digits[N * 4 + 1];
-	char* digitEnd = digits + N * 4 - 1;
-	short digit = 0;
-	int   shift = 0;
-	int   len = length();
-
-	for (int byte = 0; byte < len; digitEnd--)
-	{
+	int   count = (bitCount() + 2) / 3;
+	char* end = buf + count;
 
-		*(char*)&digit = bytes[byte];
-		if (shift >= 5)
-			if (++byte < len)
-				*(((char*)&digit) + 1) = bytes[byte];
+	if (count == 0)
+	{	buf[0] = '0';
+		return 1;
+	}
 
-		*digitEnd = ((digit >> shift) & 7) + '0';
+	for (int byte = 0; end > buf; byte += 3)
+	{
+		unsigned int group = 0;
+		for (int i = 0; i < 3 && byte + i < N; i++)
+			group |= bytes[byte + i] << (i * 8);
 
-		shift += 3;
-		if (shift >= 8)
-			shift -= 8;
+		for (int i = 0; i < 8 && end > buf; i++, group >>= 3)
+			*--end = '0' + (group & 7);
 	}
 
-	digitEnd++;
-	digits[N * 4] = 0;
-	while (digitEnd[0] == '0')
-		digitEnd++;
-
-	if (digitEnd[0] == 0)
-		return "0";
-	else
-		return str(digitEnd);
+	return count;
 }
 
-// Constructs a string of big endian order decimal digits from the value of
-// an N byte long Big Integer. The result ignores leading 0s.
-// To make sure the digits fit into the c-string, an 4N byte array is declared.
-// The sign of the Big Integer is evaluated, and if negative, the value is negated.
-// The Big Integer is processed bit by bit, and in each iteration, the array of
-// decimal digits is doubled digit by digit left to right, and if over 10, 
-// 1 is added to the previous digit, while 10 is subtracted from the current digit.
-// A Digit Counter is maintained to know how many digits does the decimal number take up.
-// After the entire array was multiplied by 2, the bit is added to the smallest digit.
-// The byte mask that handles the bit extraction from bytes is also maintained.
-// After all bits were processed, the array is incremented by '0' for ASCII digits.
-// If the number was originally negative, the - sign is appended at the start.
+// Writes the big endian order decimal digits of an N byte long Big Integer into a buffer
+// of at least maxChars(10) characters, without a terminating 0. The result ignores leading 0s.
+// The value is copied into limbs and converted right to left at the end of the buffer
+// (see limb_to_dec), then the digits are moved to its start. The number of digits is returned.
 template <unsigned int N>
-str BigInt<N>::str10() const
+int BigInt<N>::chars10(char* buf) const
 {
-	int   digitCtr = 1;
-	char  digitRaw[N * 4 + 1];
-	char* digitEnd = digitRaw + N * 4;
-	memset(digitRaw, 0, N * 4 + 1);
-
-	unsigned char copy[N];
-	memcpy(copy, bytes, N);
-
-	//For each byte and all bits in the bytes
-	unsigned char mask = 128;
-	for (int i = length() - 1; i >= 0; )
-	{
-		for (int j = digitCtr; j > 0; j--)
-		{
-			//Multiply number by 2 and handle the carry
-			digitEnd[-j] += digitEnd[-j];
-			if (digitEnd[-j] >= 10)
-			{
-				digitEnd[-j] -= 10;
-				digitEnd[-j - 1]++;
-
-				//Maintain Digit Counter if largest number had overflow
-				if (j == digitCtr)
-					digitCtr++;
-			}
-		}
-
-		// Add the bit to the number
-		if ((copy[i] & mask) == mask)
-			digitEnd[-1]++;
-
-		// (Shift) || (Reset the mask && Move to the next byte)
-		if (mask == 1)
-		{	mask = 128;
-			i--;
-		}
-		else
-			mask >>= 1;
-	}
+	const int len = (N + sizeof(limb) - 1) / sizeof(limb);
+	limb  value[len];
+	char* end = buf + maxChars(10);
 
-	// Make digits
-	for (int i = digitCtr; i>0; i--)
-		digitEnd[-i] += '0';
+	memset(value, 0, len * sizeof(limb));
+	memcpy(value, bytes, N);
 
-	return str(digitEnd - digitCtr);
+	char* start = limb_to_dec(end, value, len);
+	memmove(buf, start, end - start);
+	return (int)(end - start);
 }
 
-// Constructs a string of big endian order hexadecimal digits from the value of
-// an N byte long Big Integer. The result ignores leading 0s.
-// The digits are looked up in an array of characters where the numeric value
-// is the index to the corresponding digit. 4 bits are processed at once using & and >>.
-// Leading zeros are removed from the string, and if all digits were removed,
-// "0" is returned as a special case.
+// Writes the big endian order hexadecimal digits of an N byte long Big Integer into a buffer
+// of at least N*2 characters, without a terminating 0. The result ignores leading 0s.
+// If the top byte is less than 16, it is written as one digit, the rest of the bytes are
+// written as two digits each (see hex_encode). The number of digits written is returned.
 template <unsigned int N>
-str BigInt<N>::str16() const
+int BigInt<N>::chars16(char* buf) const
 {
-	int   digitCtr = 0;
-	char  digitRaw[N * 2 + 1];
-	char* digitStart = digitRaw;
+	int len = length();
+	char* end = buf;
 
-	for (int i = length() - 1; i >= 0; i--)
-	{
-		digitRaw[digitCtr++] = b16[(bytes[i] & 0xF0) >> 4];
-		digitRaw[digitCtr++] = b16[(bytes[i] & 0x0F)];
+	if (len == 0)
+	{	buf[0] = '0';
+		return 1;
 	}
 
-	digitRaw[digitCtr] = 0;
-	while (digitStart[0] == '0')
-		digitStart++;
+	if (bytes[len - 1] < 16)
+	{	*end++ = b16[bytes[--len]];
+	}
 
-	if (digitStart[0] == 0)
-		return "0";
-	else
-		return str(digitStart);
+	end = hex_encode(end, bytes, len);
+	return (int)(end - buf);
 }
 
-//STUB
+// Writes the base64 digits of an N byte long Big Integer into a buffer of at least
+// (N+2)/3*4 characters, without a terminating 0. The digits encode the big endian bytes
+// of the number without leading 0 bytes, with = padding, and 0 is encoded as one 0 byte.
+// The bytes are reversed into a stack array with room for the reads of b64_encode.
+// The number of digits written is returned.
 template <unsigned int N>
-str BigInt<N>::str64() const
+int BigInt<N>::chars64(char* buf) const
 {
-	char  digitRaw[(N / 3 + 1) * 4 + 1];
-	char* digitStart = digitRaw;
+	unsigned char be[N + 16];
 	int len = length();
 
-	long num;
+	if (len == 0)
+		len = 1;
 
-	for (int i = len - 3; i >= 0; i -= 3, digitStart += 4)
-	{
-		((char*)&num)[0] = bytes[i];
-		((char*)&num)[1] = bytes[i + 1];
-		((char*)&num)[2] = bytes[i + 2];
-
-		digitStart[3] = b64[num & 63];
-		num >>= 6;
-		digitStart[2] = b64[num & 63];
-		num >>= 6;
-		digitStart[1] = b64[num & 63];
-		num >>= 6;
-		digitStart[0] = b64[num & 63];
-	}
+	for (int i = 0; i < len; i++)
+		be[i] = bytes[len - 1 - i];
+
+	return (int)(b64_encode(buf, be, len) - buf);
+}
 
-	if (len % 3 == 1)
+// Writes the digits of an N byte long Big Integer in a base (2, 8, 10, 16, 64) into a buffer
+// of at least maxChars(base) characters, without a terminating 0.
+// Returns the number of digits written, or -1 if the base is invalid.
+template <unsigned int N>
+int BigInt<N>::chars(char* buf, int base) const
+{
+	switch (base)
 	{
-		char leftover = *bytes;
-		digitStart[3] = '=';
-		digitStart[2] = '=';
-		digitStart[1] = b64[(leftover & 3) << 4];
-		digitStart[0] = b64[(leftover & 252) >> 2];
+	case 2:  return chars2(buf);
+	case 8:  return chars8(buf);
+	case 10: return chars10(buf);
+	case 16: return chars16(buf);
+	case 64: return chars64(buf);
+	default: return -1;
 	}
+}
 
-	if (len % 3 == 2)
+// Returns the most digits an N byte long Big Integer can take in a base (2, 8, 10, 16, 64),
+// without a prefix and a terminating 0, or -1 if the base is invalid.
+// 8N bits take at most 8N*log10(2) + 1 < N*2.41 + 1 decimal digits.
+template <unsigned int N>
+int BigInt<N>::maxChars(int base)
+{
+	switch (base)
 	{
-		short leftover = *(short*)bytes;
-		digitStart[3] = '=';
-		digitStart[2] = b64[(leftover & 15) << 2];
-		digitStart[1] = b64[(leftover & 1008) >> 4];
-		digitStart[0] = b64[(leftover & 64512) >> 10];
+	case 2:  return N * 8;
+	case 8:  return (N * 8 + 2) / 3;
+	case 10: return N * 241 / 100 + 1;
+	case 16: return N * 2;
+	case 64: return (N + 2) / 3 * 4;
+	default: return -1;
 	}
+}
 
-	digitRaw[(len / 3 + 1) * 4] = 0;
-	return str(digitRaw);
+// Constructs a string of big endian order binary digits from the value of
+// an N byte long Big Integer. The result ignores leading 0s.
+template <unsigned int N>
+str BigInt<N>::str2() const
+{
+	char digits[N * 8];
+	return str(digits, chars2(digits));
+}
+
+// Constructs a string of big endian order octal digits from the value of
+// an N byte long Big Integer. The result ignores leading 0s.
+template <unsigned int N>
+str BigInt<N>::str8() const
+{
+	char digits[(N * 8 + 2) / 3];
+	return str(digits, chars8(digits));
+}
+
+// Constructs a string of big endian order decimal digits from the value of
+// an N byte long Big Integer. The result ignores leading 0s.
+template <unsigned int N>
+str BigInt<N>::str10() const
+{
+	char digits[N * 241 / 100 + 1];
+	return str(digits, chars10(digits));
+}
+
+// Constructs a string of big endian order hexadecimal digits from the value of
+// an N byte long Big Integer. The result ignores leading 0s.
+template <unsigned int N>
+str BigInt<N>::str16() const
+{
+	char digits[N * 2];
+	return str(digits, chars16(digits));
+}
+
+// Constructs a string of base64 digits from the value of an N byte long Big Integer.
+template <unsigned int N>
+str BigInt<N>::str64() const
+{
+	char digits[(N + 2) / 3 * 4];
+	return str(digits, chars64(digits));
 }
 
 // Returns a string of big endian order digits of a Big Integer of N bytes.
@@ -241,4 +226,43 @@ str BigInt<N>::toString(int base, bool prefix) const
 	case 64: return (prefix ? "0#" : "") + str64();
 	default: return "";
 	}
-}
\ No newline at end of file
+}
+
+// Writes the digits of a Big Integer of N bytes in a base (2, 8, 10, 16, 64) into a buffer
+// of size characters with a terminating 0, without allocations. The base prefix can be
+// optionally written before the digits. If the buffer has room for maxChars(base) digits
+// and the prefix, the digits are written directly, otherwise through a stack array.
+// Returns the number of characters written without the terminating 0,
+// or -1 if the base is invalid or the result does not fit.
+template <unsigned int N>
+int BigInt<N>::toChars(char* buf, int size, int base, bool prefix) const
+{
+	cstr pre = "";
+	int  max = maxChars(base);
+
+	if (max < 0 || buf == NULL)
+		return -1;
+
+	if (prefix)
+		pre = base == 2 ? "0b" : base == 8 ? "0" : base == 16 ? "0x" : base == 64 ? "0#" : "";
+
+	int plen = strlen(pre);
+	int count;
+
+	if (size > plen + max)
+	{	count = chars(buf + plen, base);
+	}
+	else
+	{
+		char digits[N * 8];
+		count = chars(digits, base);
+		if (size <= plen + count)
+			return -1;
+
+		memcpy(buf + plen, digits, count);
+	}
+
+	memcpy(buf, pre, plen);
+	buf[plen + count] = 0;
+	return plen + count;
+}
@@ -0,0 +1,411 @@
+//----------------------------------------------------------------------------//
+//                            Radix Conversion Kernels                        //
+//--------------------------------------------------------------------------- //
+
+// Number of decimal digits that always fit in a limb, and 10 to that power.
+// Decimal conversions handle this many digits with a single limb operation.
+#if defined(_X64)
+#define LIMB_DEC_DIGITS 19
+#define LIMB_DEC_BASE   10000000000000000000ULL
+#else
+#define LIMB_DEC_DIGITS 9
+#define LIMB_DEC_BASE   1000000000U
+#endif
+
+// Number of limbs at and below which decimal conversions work one limb of digits at a time.
+// Above it, the number is split at a power of 10 and the halves are converted separately,
+// which moves the work into the multiplication and division kernels.
+#ifndef BIGINT_DEC_DC_THRESHOLD
+#define BIGINT_DEC_DC_THRESHOLD 16
+#endif
+
+// Parses len decimal digits into L limbs of r, one limb of digits at a time.
+// r is multiplied by 10^k and the next k digits are added, only over the limbs in use.
+// Digits must be valid. The result is modulo 2^(L*w), like the rest of the arithmetic.
+static inline void limb_from_dec_basecase(limb* r, int L, const char* digits, int len)
+{
+	int used = 0;
+	int take = len % LIMB_DEC_DIGITS ? len % LIMB_DEC_DIGITS : LIMB_DEC_DIGITS;
+
+	memset(r, 0, L * sizeof(limb));
+	for (; len > 0; digits += take, len -= take, take = LIMB_DEC_DIGITS)
+	{
+		limb chunk = 0, scale = 1;
+		for (int i = 0; i < take; i++)
+		{	chunk = chunk * 10 + (digits[i] - '0');
+			scale *= 10;
+		}
+
+		for (int i = 0; i < used; i++)
+		{	r[i] = limb_mac(r[i], scale, chunk, 0, chunk);
+		}
+		if (chunk && used < L)
+		{	r[used++] = chunk;
+		}
+	}
+}
+
+// Parses len decimal digits into L limbs of r by splitting them in two.
+// The low part takes 2^k limbs worth of digits, so that it is at least as long as the high part,
+// and r = high * pows[k] + low, where pows[k] is 10^(LIMB_DEC_DIGITS*2^k) modulo 2^(L*w).
+// Every level of the recursion takes 3L limbs and the multiplication scratch from work.
+static inline void limb_from_dec_dc(limb* r, int L, const char* digits, int len, const limb* pows, limb* work)
+{
+	if (len <= LIMB_DEC_DIGITS * BIGINT_DEC_DC_THRESHOLD)
+	{	limb_from_dec_basecase(r, L, digits, len);
+		return;
+	}
+
+	int k = 0;
+	while ((LIMB_DEC_DIGITS << (k + 1)) < len)
+	{	k++;
+	}
+
+	int   low  = LIMB_DEC_DIGITS << k;
+	limb* lo   = work;
+	limb* prod = work + L;
+	limb* next = work + L * 3;
+
+	limb_from_dec_dc(r, L, digits, len - low, pows, next);
+	limb_from_dec_dc(lo, L, digits + len - low, low, pows, next);
+
+	int nr = limb_length(r, L);
+	int np = limb_length(pows + k * L, L);
+
+	limb_mul(prod, r, nr, pows + k * L, np, next);
+	memset(prod + nr + np, 0, (L * 2 - nr - np) * sizeof(limb));
+	memcpy(r, prod, L * sizeof(limb));
+	limb_add(r, lo, L);
+}
+
+// Parses len decimal digits into L limbs of r. Short strings are parsed a limb at a time,
+// long ones are split recursively, with the powers of 10 of the splits squared up front.
+// Digits must be valid. The result is modulo 2^(L*w).
+static inline void limb_from_dec(limb* r, int L, const char* digits, int len)
+{
+	if (len <= LIMB_DEC_DIGITS * BIGINT_DEC_DC_THRESHOLD)
+	{	limb_from_dec_basecase(r, L, digits, len);
+		return;
+	}
+
+	int levels = 1;
+	while ((LIMB_DEC_DIGITS << levels) < len)
+	{	levels++;
+	}
+
+	int level = L * 3 + limb_mul_scratch(L);
+	ScratchFrame frame((L * levels + level * (levels + 1)) * sizeof(limb));
+	limb* pows = (limb*)frame.data();
+	limb* work = pows + L * levels;
+
+	memset(pows, 0, L * sizeof(limb));
+	pows[0] = LIMB_DEC_BASE;
+
+	for (int k = 1; k < levels; k++)
+	{
+		const limb* p = pows + (k - 1) * L;
+		int np = limb_length(p, L);
+
+		limb_sqr(work, p, np, work + L * 2);
+		memset(work + np * 2, 0, (L * 2 - np * 2) * sizeof(limb));
+		memcpy(pows + k * L, work, L * sizeof(limb));
+	}
+
+	limb_from_dec_dc(r, L, digits, len, pows, work);
+}
+
+// Writes the decimal digits of len limbs of v right to left, ending before end,
+// one limb of digits at a time: dividing v by 10^LIMB_DEC_DIGITS leaves the lowest digits
+// in the remainder. At least width digits are written, padded with 0s on the left.
+// v is destroyed. The first digit written is returned.
+static inline char* limb_to_dec_basecase(char* end, limb* v, int len, int width)
+{
+	char* start = end - width;
+
+	len = limb_length(v, len);
+	while (len > 0)
+	{
+		limb rem = limb_divmod_1(v, v, len, LIMB_DEC_BASE);
+		len = limb_length(v, len);
+
+		for (int i = 0; i < LIMB_DEC_DIGITS && (len > 0 || rem); i++)
+		{	*--end = '0' + (char)(rem % 10);
+			rem /= 10;
+		}
+	}
+
+	while (end > start)
+	{	*--end = '0';
+	}
+	return end;
+}
+
+// Writes the decimal digits of len limbs of v right to left by splitting it in two.
+// The largest pows[k] = 10^(LIMB_DEC_DIGITS*2^k) with at most half the limbs of v divides it,
+// the remainder is written with exactly LIMB_DEC_DIGITS*2^k digits and the quotient in front of it.
+// Every level takes 3len+2 limbs from work. v is destroyed. The first digit written is returned.
+static inline char* limb_to_dec_dc(char* end, limb* v, int len, int width, limb* const* pows, const int* plen, limb* work)
+{
+	len = limb_length(v, len);
+	if (len <= BIGINT_DEC_DC_THRESHOLD)
+	{	return limb_to_dec_basecase(end, v, len, width);
+	}
+
+	int k = 0;
+	while (plen[k + 1] && plen[k + 1] * 2 - 1 <= len)
+	{	k++;
+	}
+
+	int   np  = plen[k];
+	int   low = LIMB_DEC_DIGITS << k;
+	limb* q   = work;
+	limb* rem = q + len - np + 1;
+	limb* next = rem + np;
+
+	limb_divmod(q, rem, v, len, pows[k], np, next);
+
+	end = limb_to_dec_dc(end, rem, np, low, pows, plen, next);
+	return limb_to_dec_dc(end, q, len - np + 1, width > low ? width - low : 0, pows, plen, next);
+}
+
+// Writes the decimal digits of len limbs of v right to left, ending before end, without leading 0s.
+// Short numbers are converted a limb at a time, long ones are split recursively, with the
+// powers of 10 of the splits squared up front. v is destroyed. The first digit written is returned.
+static inline char* limb_to_dec(char* end, limb* v, int len)
+{
+	len = limb_length(v, len);
+	if (len <= BIGINT_DEC_DC_THRESHOLD)
+	{	return limb_to_dec_basecase(end, v, len, 1);
+	}
+
+	// pows[k] has at most 2^k limbs and they are squared while they fit into len+1 limbs,
+	// so the table takes less than 2(len+1) limbs plus 1 for each level.
+	limb* pows[32];
+	int   plen[33];
+	int   levels = 0;
+	int   table = len * 2 + 2 + 32;
+	int   level = len * 3 + 2;
+
+	ScratchFrame frame((table + limb_mul_scratch(len) + level * 32) * sizeof(limb));
+	limb* top = (limb*)frame.data();
+
+	pows[0] = top++;
+	pows[0][0] = LIMB_DEC_BASE;
+	plen[0] = 1;
+
+	while (++levels < 32 && plen[levels - 1] * 2 - 1 <= len)
+	{
+		int np = plen[levels - 1];
+		pows[levels] = top;
+		limb_sqr(top, pows[levels - 1], np, (limb*)frame.data() + table);
+		plen[levels] = limb_length(top, np * 2);
+		top += np * 2;
+	}
+	plen[levels] = 0;
+
+	return limb_to_dec_dc(end, v, len, 1, pows, plen, (limb*)frame.data() + table);
+}
+
+// Writes the 2*len hexadecimal digits of len little endian bytes into out, most significant first.
+// With SSSE3, 16 bytes are reversed with a shuffle, split into high and low nibbles,
+// and the nibbles index the digit table in a register, which gives 32 digits per iteration.
+static inline char* hex_encode(char* out, const unsigned char* bytes, int len)
+{
+	int i = len - 1;
+
+#if defined(_SSSE3)
+	const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const __m128i digits  = _mm_loadu_si128((const __m128i*)b16);
+	const __m128i nibble  = _mm_set1_epi8(15);
+
+	for (; i >= 15; i -= 16, out += 32)
+	{
+		__m128i v  = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(bytes + i - 15)), reverse);
+		__m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+		__m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, nibble));
+
+		_mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128((__m128i*)(out + 16), _mm_unpackhi_epi8(hi, lo));
+	}
+#endif
+
+	for (; i >= 0; i--)
+	{	*out++ = b16[bytes[i] >> 4];
+		*out++ = b16[bytes[i] & 15];
+	}
+	return out;
+}
+
+// Writes len big endian bytes into out in base64 format with = padding, (len+2)/3*4 characters.
+// With SSSE3, 12 bytes are spread to 16 lanes of 6 bits with a shuffle and two multiplications,
+// then each lane is turned into its character by adding an offset looked up from its range
+// (A-Z, a-z, 0-9, +, /). The loads read 16 bytes, so 4 bytes after the input must be readable.
+static inline char* b64_encode(char* out, const unsigned char* bytes, int len)
+{
+	int i = 0;
+
+#if defined(_SSSE3)
+	const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+	const __m128i offset = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+	for (; i + 12 <= len; i += 12, out += 16)
+	{
+		__m128i v  = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(bytes + i)), spread);
+		__m128i t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+		__m128i t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+		__m128i x  = _mm_or_si128(t0, t1);
+
+		__m128i r  = _mm_subs_epu8(x, _mm_set1_epi8(51));
+		r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), x), _mm_set1_epi8(13)));
+		_mm_storeu_si128((__m128i*)out, _mm_add_epi8(x, _mm_shuffle_epi8(offset, r)));
+	}
+#endif
+
+	for (; i + 3 <= len; i += 3, out += 4)
+	{
+		unsigned int v = (bytes[i] << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+		out[0] = b64[v >> 18];
+		out[1] = b64[(v >> 12) & 63];
+		out[2] = b64[(v >> 6) & 63];
+		out[3] = b64[v & 63];
+	}
+
+	if (len - i == 1)
+	{	out[0] = b64[bytes[i] >> 2];
+		out[1] = b64[(bytes[i] & 3) << 4];
+		out[2] = out[3] = '=';
+		out += 4;
+	}
+	else if (len - i == 2)
+	{	out[0] = b64[bytes[i] >> 2];
+		out[1] = b64[((bytes[i] & 3) << 4) | (bytes[i + 1] >> 4)];
+		out[2] = b64[(bytes[i + 1] & 15) << 2];
+		out[3] = '=';
+		out += 4;
+	}
+	return out;
+}
+
+#if defined(_SSSE3)
+// Finds the values of 16 hexadecimal digits. Lanes that are not digits are cleared in valid.
+// Digits are c - '0' in 0..9, letters are (c | 0x20) - 'a' in 0..5 for both cases.
+static inline __m128i hex_values(__m128i c, __m128i &valid)
+{
+	__m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+	__m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+	__m128i isDigit  = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+	__m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+
+	valid = _mm_and_si128(valid, _mm_or_si128(isDigit, isLetter));
+	return _mm_or_si128(_mm_and_si128(isDigit, d), _mm_and_si128(isLetter, _mm_add_epi8(l, _mm_set1_epi8(10))));
+}
+#endif
+
+// Reads 2*len hexadecimal digits, most significant first, into len little endian bytes.
+// The digit values are looked up in the v16 table, two digits per byte.
+// With SSSE3, 32 digits are checked and converted at once, pairs of digits are joined with
+// a multiply-add and the 16 bytes are reversed with a shuffle.
+// Returns -1 if a character is not a hexadecimal digit, otherwise 0.
+static inline int hex_decode(unsigned char* bytes, const char* digits, int len)
+{
+	int i = len - 1;
+
+#if defined(_SSSE3)
+	const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const __m128i join = _mm_set1_epi16(0x0110);
+	__m128i valid = _mm_set1_epi8(-1);
+
+	for (; i >= 15; i -= 16, digits += 32)
+	{
+		__m128i hi = hex_values(_mm_loadu_si128((const __m128i*)digits), valid);
+		__m128i lo = hex_values(_mm_loadu_si128((const __m128i*)(digits + 16)), valid);
+		__m128i v  = _mm_packus_epi16(_mm_maddubs_epi16(hi, join), _mm_maddubs_epi16(lo, join));
+
+		_mm_storeu_si128((__m128i*)(bytes + i - 15), _mm_shuffle_epi8(v, reverse));
+	}
+
+	if (_mm_movemask_epi8(valid) != 0xFFFF)
+		return -1;
+#endif
+
+	for (; i >= 0; i--, digits += 2)
+	{
+		int hi = v16[(unsigned char)digits[0]];
+		int lo = v16[(unsigned char)digits[1]];
+		if ((hi | lo) < 0)
+			return -1;
+
+		bytes[i] = (hi << 4) | lo;
+	}
+	return 0;
+}
+
+// Writes the 8*len binary digits of len little endian bytes into out, most significant first.
+// A byte is copied to the 8 bytes of a word, each byte keeps one bit with a mask, then adding
+// 0x7F moves any set bit to the top of its byte, which is shifted down and added to '0'.
+// With SSSE3, 2 bytes are spread to 16 lanes with a shuffle and compared to the bit masks.
+static inline char* bin_encode(char* out, const unsigned char* bytes, int len)
+{
+	int i = len - 1;
+
+#if defined(_SSSE3)
+	const __m128i spread = _mm_setr_epi8(1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i bits = _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+
+	for (; i >= 1; i -= 2, out += 16)
+	{
+		__m128i v = _mm_shuffle_epi8(_mm_cvtsi32_si128(bytes[i - 1] | (bytes[i] << 8)), spread);
+		v = _mm_cmpeq_epi8(_mm_and_si128(v, bits), bits);
+		_mm_storeu_si128((__m128i*)out, _mm_sub_epi8(_mm_set1_epi8('0'), v));
+	}
+#endif
+
+	for (; i >= 0; i--, out += 8)
+	{
+		unsigned long long x = (bytes[i] * 0x0101010101010101ULL) & 0x0102040810204080ULL;
+		x = ((x + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+		x += 0x3030303030303030ULL;
+		memcpy(out, &x, 8);
+	}
+	return out;
+}
+
+// Reads 8*len binary digits, most significant first, into len little endian bytes.
+// 8 digits are read as a word and checked at once, since only '0' and '1' are 0x30 without
+// their lowest bit. The lowest bits are gathered into the top byte with one multiplication.
+// With SSSE3, 16 digits are compared to '1', reversed, and their top bits give 2 bytes.
+// Returns -1 if a character is not a binary digit, otherwise 0.
+static inline int bin_decode(unsigned char* bytes, const char* digits, int len)
+{
+	int i = len - 1;
+
+#if defined(_SSSE3)
+	const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	__m128i valid = _mm_set1_epi8(-1);
+
+	for (; i >= 1; i -= 2, digits += 16)
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*)digits);
+		valid = _mm_and_si128(valid, _mm_cmpeq_epi8(_mm_and_si128(c, _mm_set1_epi8(-2)), _mm_set1_epi8('0')));
+
+		int v = _mm_movemask_epi8(_mm_shuffle_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('1')), reverse));
+		bytes[i - 1] = (unsigned char)v;
+		bytes[i] = (unsigned char)(v >> 8);
+	}
+
+	if (_mm_movemask_epi8(valid) != 0xFFFF)
+		return -1;
+#endif
+
+	for (; i >= 0; i--, digits += 8)
+	{
+		unsigned long long x;
+		memcpy(&x, digits, 8);
+		if ((x & 0xFEFEFEFEFEFEFEFEULL) != 0x3030303030303030ULL)
+			return -1;
+
+		bytes[i] = (unsigned char)(((x & 0x0101010101010101ULL) * 0x8040201008040201ULL) >> 56);
+	}
+	return 0;
+}
@@ -70,8 +70,9 @@ bool BigInt<N>::isZero() const
     "1: \n"
         "movb $0, %0 \n"
     "2: \n"
-        : "=m" (res)
+        : "+m" (res)
         : "m" (begp), "m" (endp)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
     );
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -92,8 +93,9 @@ bool BigInt<N>::isZero() const
     "1: \n"
         "movb $0, %0 \n"
     "2: \n"
-        : "=m" (res)
+        : "+m" (res)
         : "m" (begp), "m" (endp)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
     );
 #endif
 
@@ -212,8 +214,9 @@ bool BigInt<N>::operator>=(const BigInt<N> &right) const
 	"1: \n"
 		"movb $0, %0 \n"
 	"2: \n"
-        : "=m" (res)
+        : "+m" (res)
         : "m" (r), "m" (l), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
 	);
 #elif defined(_GAS_ATT) && defined(_X32)
     __asm__
@@ -239,8 +242,9 @@ bool BigInt<N>::operator>=(const BigInt<N> &right) const
     "1: \n"
         "movb $0, %0 \n"
     "2: \n"
-        : "=m" (res)
+        : "+m" (res)
         : "m" (r), "m" (l), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
     );
 #endif
 
@@ -335,8 +339,9 @@ bool BigInt<N>::operator<=(const BigInt<N> &right) const
 	"1: \n"
 		"movb $0, %0 \n"
 	"2: \n"
-	    : "=m" (res)
+	    : "+m" (res)
         : "m" (r), "m" (l), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
 	);
 #elif defined(_GAS_ATT) && defined(_X32)
 	__asm__
@@ -362,8 +367,9 @@ bool BigInt<N>::operator<=(const BigInt<N> &right) const
 	"1: \n"
 		"movb $0, %0 \n"
 	"2: \n"
-	    : "=m" (res)
+	    : "+m" (res)
         : "m" (r), "m" (l), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
 	);
 #endif
 
@@ -454,8 +460,9 @@ bool BigInt<N>::operator==(const BigInt<N> &right) const
 	"1: \n"
 		"movb $0, %0 \n"
 	"2: \n"
-	    : "=m" (res)
+	    : "+m" (res)
         : "m" (r), "m" (l), "m" (len)
+        : "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "memory", "cc"
 	);
 #elif defined(_GAS_ATT) && defined(_X32)
 	__asm__
@@ -480,8 +487,9 @@ bool BigInt<N>::operator==(const BigInt<N> &right) const
 	"1: \n"
 		"movb $0, %0 \n"
 	"2: \n"
-	    : "=m" (res)
+	    : "+m" (res)
         : "m" (r), "m" (l), "m" (len)
+        : "eax", "ebx", "ecx", "edx", "esi", "edi", "memory", "cc"
 	);
 #endif
 
@@ -0,0 +1,74 @@
+//----------------------------------------------------------------------------//
+//                                Scratch Memory                              //
+//--------------------------------------------------------------------------- //
+
+// Scratch memory of a thread for the temporaries of the arithmetic kernels.
+// The buffer is reused by every call on the thread, so the kernels need neither
+// stack space in proportion to N, nor heap allocations per call.
+struct ScratchArena
+{
+	unsigned char* base;
+	size_t size;
+	size_t top;
+	size_t peak;
+
+	ScratchArena() : base(NULL), size(0), top(0), peak(0) {}
+	~ScratchArena() { delete[] base; }
+};
+
+// Gets the scratch arena of the calling thread
+inline ScratchArena& scratch_arena()
+{
+	static thread_local ScratchArena arena;
+	return arena;
+}
+
+// Takes bytes from the scratch arena of the calling thread and gives them back when
+// it goes out of scope, so frames nest in stack order. The arena can only be resized
+// when nothing is taken from it, so when a nested frame does not fit, it is allocated
+// on the heap, and the arena grows to the largest size seen at the next outermost frame.
+class ScratchFrame
+{
+private:
+	ScratchArena&  arena;
+	size_t         mark;
+	unsigned char* heap;
+	unsigned char* ptr;
+
+	ScratchFrame(const ScratchFrame&);
+	ScratchFrame& operator=(const ScratchFrame&);
+
+public:
+	ScratchFrame(size_t bytes)
+		: arena(scratch_arena()), mark(arena.top), heap(NULL)
+	{
+		bytes = (bytes + 15) & ~(size_t)15;
+		if (arena.top + bytes > arena.peak)
+		{	arena.peak = arena.top + bytes;
+		}
+
+		if (arena.top == 0 && arena.size < arena.peak)
+		{	delete[] arena.base;
+			arena.base = new unsigned char[arena.peak];
+			arena.size = arena.peak;
+		}
+
+		if (arena.top + bytes <= arena.size)
+		{	ptr = arena.base + arena.top;
+			arena.top += bytes;
+		}
+		else
+		{	ptr = heap = new unsigned char[bytes];
+		}
+	}
+
+	~ScratchFrame()
+	{
+		arena.top = mark;
+		delete[] heap;
+	}
+
+	unsigned char* data() const
+	{	return ptr;
+	}
+};
@@ -0,0 +1,399 @@
+//----------------------------------------------------------------------------//
+//                         Constructors and Assignment                        //
+//--------------------------------------------------------------------------- //
+
+// Constructs a Big Number of the value 0, which has no limbs.
+// The limbs are kept inside the object until the number grows beyond BIGNUM_INLINE_LIMBS.
+inline BigNum::BigNum()
+	: data(local), length(0), capacity(BIGNUM_INLINE_LIMBS)
+{
+}
+
+// Constructs a Big Number from a machine word, which takes 1 limb on x64 and 2 on x86.
+inline BigNum::BigNum(const unsigned long long val)
+	: data(local), length(sizeof(val) / sizeof(limb)), capacity(BIGNUM_INLINE_LIMBS)
+{
+	memcpy(data, &val, sizeof(val));
+	normalize();
+}
+
+// Constructs a Big Number from len bytes of memory in big or little endian byte order.
+// The leading 0 bytes of the number, like the sign byte of an ASN.1 integer, are dropped.
+inline BigNum::BigNum(const void* mem, size_t len, bool bigEndian)
+	: data(local), length(0), capacity(BIGNUM_INLINE_LIMBS)
+{
+	const unsigned char* src = (const unsigned char*)mem;
+	int limbs = (int)((len + sizeof(limb) - 1) / sizeof(limb));
+
+	reserve(limbs);
+	memset(data, 0, limbs * sizeof(limb));
+
+	unsigned char* dst = (unsigned char*)data;
+	if (bigEndian)
+	{	for (size_t i = 0; i < len; i++)
+		{	dst[i] = src[len - i - 1];
+		}
+	}
+	else
+	{	memcpy(dst, src, len);
+	}
+
+	length = limbs;
+	normalize();
+}
+
+// Constructs a Big Number from the value of a Big Integer of N bytes.
+template <unsigned int N>
+BigNum::BigNum(const BigInt<N> &val)
+	: BigNum(val.bytes, N, false)
+{
+}
+
+// Constructs a Big Number with the value of another one. Only the significant limbs are copied.
+inline BigNum::BigNum(const BigNum &other)
+	: data(local), length(0), capacity(BIGNUM_INLINE_LIMBS)
+{
+	reserve(other.length);
+	memcpy(data, other.data, other.length * sizeof(limb));
+	length = other.length;
+}
+
+// Constructs a Big Number by taking the limbs of another one. Limbs on the heap are taken over,
+// inline limbs are copied, and the other number is left as 0.
+inline BigNum::BigNum(BigNum &&other)
+	: data(local), length(0), capacity(BIGNUM_INLINE_LIMBS)
+{
+	*this = std::move(other);
+}
+
+inline BigNum::~BigNum()
+{
+	if (data != local)
+	{	delete[] data;
+	}
+}
+
+inline BigNum& BigNum::operator=(const BigNum &other)
+{
+	if (this != &other)
+	{	length = 0;
+		reserve(other.length);
+		memcpy(data, other.data, other.length * sizeof(limb));
+		length = other.length;
+	}
+	return *this;
+}
+
+inline BigNum& BigNum::operator=(BigNum &&other)
+{
+	if (this == &other)
+	{	return *this;
+	}
+
+	if (other.data == other.local)
+	{	*this = (const BigNum&)other;
+	}
+	else
+	{	if (data != local)
+		{	delete[] data;
+		}
+		data     = other.data;
+		capacity = other.capacity;
+		length   = other.length;
+
+		other.data     = other.local;
+		other.capacity = BIGNUM_INLINE_LIMBS;
+	}
+
+	other.length = 0;
+	return *this;
+}
+
+// Grows the storage to at least limbs limbs, at least doubling it so a number that keeps
+// growing is moved a few times only. The significant limbs are moved to the new storage.
+inline void BigNum::reserve(int limbs)
+{
+	if (limbs <= capacity)
+	{	return;
+	}
+
+	int   size = limbs > capacity * 2 ? limbs : capacity * 2;
+	limb* mem  = new limb[size];
+	memcpy(mem, data, length * sizeof(limb));
+
+	if (data != local)
+	{	delete[] data;
+	}
+	data     = mem;
+	capacity = size;
+}
+
+inline void BigNum::normalize()
+{
+	length = limb_length(data, length);
+}
+
+//----------------------------------------------------------------------------//
+//                                 Conversions                                //
+//--------------------------------------------------------------------------- //
+
+// Copies the value into a Big Integer of N bytes.
+// Returns false and leaves the Big Integer unchanged if the value does not fit into it.
+template <unsigned int N>
+bool BigNum::toBigInt(BigInt<N> &out) const
+{
+	int bytes = byteCount();
+	if (bytes > (int)N)
+	{	return false;
+	}
+
+	memset(out.bytes, 0, N);
+	memcpy(out.bytes, data, bytes);
+	return true;
+}
+
+// Writes the value into len bytes of memory in big or little endian byte order, padded with 0s.
+// Returns the number of bytes written, or -1 if the value does not fit.
+inline int BigNum::toBytes(void* mem, size_t len, bool bigEndian) const
+{
+	size_t bytes = byteCount();
+	if (bytes > len)
+	{	return -1;
+	}
+
+	unsigned char* dst = (unsigned char*)mem;
+	const unsigned char* src = (const unsigned char*)data;
+
+	memset(dst, 0, len);
+	if (bigEndian)
+	{	for (size_t i = 0; i < bytes; i++)
+		{	dst[len - i - 1] = src[i];
+		}
+	}
+	else
+	{	memcpy(dst, src, bytes);
+	}
+
+	return (int)len;
+}
+
+// Counts the bits up to the most significant 1 bit from the leading zeros of the top limb.
+inline int BigNum::bitCount() const
+{
+	if (length == 0)
+	{	return 0;
+	}
+	return length * (int)LIMB_BITS - limb_clz(data[length - 1]);
+}
+
+inline int BigNum::byteCount() const
+{
+	return (bitCount() + 7) / 8;
+}
+
+//----------------------------------------------------------------------------//
+//                       Relational and Bitwise Operators                     //
+//--------------------------------------------------------------------------- //
+
+// Compares two Big Numbers. Numbers with more limbs are greater, otherwise the limbs
+// are compared from the most significant one. Returns 1, -1 or 0 like limb_cmp.
+inline int BigNum::compare(const BigNum &right) const
+{
+	if (length != right.length)
+	{	return length > right.length ? 1 : -1;
+	}
+	return limb_cmp(data, right.data, length);
+}
+
+inline BigNum BigNum::operator<<(const int count) const
+{
+	BigNum res(*this);
+	res <<= count;
+	return res;
+}
+
+inline BigNum BigNum::operator>>(const int count) const
+{
+	BigNum res(*this);
+	res >>= count;
+	return res;
+}
+
+// Shifts the number to the left by whole limbs and the remaining bits in one pass of limb_shl.
+// The number grows by the limbs shifted in and the limb of the bits shifted out of the top.
+inline BigNum& BigNum::operator<<=(const int count)
+{
+	if (count <= 0 || length == 0)
+	{	return *this;
+	}
+
+	int limbs = count / (int)LIMB_BITS;
+	int bits  = count % (int)LIMB_BITS;
+
+	reserve(length + limbs + 1);
+	data[length + limbs] = limb_shl(data + limbs, data, length, bits);
+	memset(data, 0, limbs * sizeof(limb));
+
+	length += limbs + 1;
+	normalize();
+	return *this;
+}
+
+// Shifts the number to the right by whole limbs and the remaining bits in one pass of limb_shr.
+inline BigNum& BigNum::operator>>=(const int count)
+{
+	if (count <= 0 || length == 0)
+	{	return *this;
+	}
+
+	int limbs = count / (int)LIMB_BITS;
+	int bits  = count % (int)LIMB_BITS;
+
+	if (limbs >= length)
+	{	length = 0;
+		return *this;
+	}
+
+	limb_shr(data, data + limbs, length - limbs, bits);
+	length -= limbs;
+	normalize();
+	return *this;
+}
+
+//----------------------------------------------------------------------------//
+//                            Arithmetic Operators                            //
+//--------------------------------------------------------------------------- //
+
+inline BigNum BigNum::operator+(const BigNum &right) const
+{
+	BigNum res(*this);
+	res += right;
+	return res;
+}
+
+inline BigNum BigNum::operator-(const BigNum &right) const
+{
+	BigNum res(*this);
+	res -= right;
+	return res;
+}
+
+inline BigNum BigNum::operator/(const BigNum &right) const
+{
+	BigNum res;
+	div(*this, right, &res, NULL);
+	return res;
+}
+
+inline BigNum BigNum::operator%(const BigNum &right) const
+{
+	BigNum res;
+	div(*this, right, NULL, &res);
+	return res;
+}
+
+// Adds the limbs of the right operand, then carries through the longer part of the number.
+// The number grows by one limb for the carry out of the top.
+inline BigNum& BigNum::operator+=(const BigNum &right)
+{
+	int len = length > right.length ? length : right.length;
+
+	reserve(len + 1);
+	memset(data + length, 0, (len + 1 - length) * sizeof(limb));
+
+	limb carry = limb_add(data, right.data, right.length);
+	data[len]  = limb_inc(data + right.length, len - right.length, carry);
+
+	length = len + 1;
+	normalize();
+	return *this;
+}
+
+// Subtracts the limbs of the right operand, then borrows through the rest of the number.
+// A Big Number has no sign, so a right operand that is greater throws -1.
+inline BigNum& BigNum::operator-=(const BigNum &right)
+{
+	if (compare(right) < 0)
+	{	throw -1;
+	}
+
+	limb borrow = limb_sub(data, right.data, right.length);
+	limb_dec(data + right.length, length - right.length, borrow);
+
+	normalize();
+	return *this;
+}
+
+// Multiplies the significant limbs of the operands with limb_mul, which picks the schoolbook
+// method or Karatsuba from their lengths. The product has as many limbs as the operands together.
+inline BigNum BigNum::operator*(const BigNum &right) const
+{
+	BigNum res;
+	if (length == 0 || right.length == 0)
+	{	return res;
+	}
+
+	int len = length > right.length ? length : right.length;
+	ScratchFrame frame(limb_mul_scratch(len) * sizeof(limb));
+
+	res.reserve(length + right.length);
+	limb_mul(res.data, data, length, right.data, right.length, (limb*)frame.data());
+
+	res.length = length + right.length;
+	res.normalize();
+	return res;
+}
+
+inline BigNum& BigNum::operator*=(const BigNum &right)
+{
+	*this = *this * right;
+	return *this;
+}
+
+inline BigNum& BigNum::operator/=(const BigNum &right)
+{
+	div(*this, right, this, NULL);
+	return *this;
+}
+
+inline BigNum& BigNum::operator%=(const BigNum &right)
+{
+	div(*this, right, NULL, this);
+	return *this;
+}
+
+// Divides two Big Numbers with Knuth's algorithm D on their significant limbs, writing the
+// quotient to qptr and the remainder to rptr. Either can be NULL, or one of the operands.
+// Like a Big Integer, a division by 0 gives a quotient of 0 and the dividend as the remainder.
+inline void BigNum::div(const BigNum &left, const BigNum &right, BigNum *qptr, BigNum *rptr)
+{
+	BigNum quotient;
+	BigNum remainder;
+
+	int na = left.length;
+	int nb = right.length;
+
+	if (nb == 0 || na < nb || (na == nb && limb_cmp(left.data, right.data, na) < 0))
+	{	remainder = left;
+	}
+	else
+	{
+		ScratchFrame frame((na + nb + 1) * sizeof(limb));
+
+		quotient.reserve(na - nb + 1);
+		remainder.reserve(nb);
+		limb_divmod(quotient.data, remainder.data, left.data, na, right.data, nb, (limb*)frame.data());
+
+		quotient.length  = na - nb + 1;
+		remainder.length = nb;
+		quotient.normalize();
+		remainder.normalize();
+	}
+
+	if (qptr)
+	{	*qptr = std::move(quotient);
+	}
+	if (rptr)
+	{	*rptr = std::move(remainder);
+	}
+}
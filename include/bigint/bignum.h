@@ -0,0 +1,88 @@
+#ifndef SOREING_BIGNUM_H
+#define SOREING_BIGNUM_H
+
+#include "bigint.h"
+#include <utility>
+
+// Limbs kept inside the object, which is 4096 bits. Longer numbers are kept on the heap.
+#ifndef BIGNUM_INLINE_LIMBS
+	#define BIGNUM_INLINE_LIMBS (512 / sizeof(limb))
+#endif
+
+// Unsigned integer with a length that is decided at runtime and follows its value.
+// The limbs are in little endian order like the bytes of a Big Integer, and only the
+// significant limbs are kept, so every kernel runs on the actual length of the number.
+class BigNum
+{
+private:
+	limb  local[BIGNUM_INLINE_LIMBS];
+	limb* data;
+	int   length;
+	int   capacity;
+
+	// Makes room for limbs limbs, keeping the value
+	void reserve(int limbs);
+	// Drops the leading 0 limbs from the length
+	void normalize();
+
+public:
+	// Constructors and Assignment
+	BigNum();
+	BigNum(const unsigned long long val);
+	BigNum(const void* mem, size_t len, bool bigEndian);
+	template <unsigned int N>
+	BigNum(const BigInt<N> &val);
+
+	BigNum(const BigNum &other);
+	BigNum(BigNum &&other);
+	~BigNum();
+	BigNum& operator=(const BigNum &other);
+	BigNum& operator=(BigNum &&other);
+
+	// Conversions
+	template <unsigned int N>
+	bool toBigInt(BigInt<N> &out) const;
+	int  toBytes(void* mem, size_t len, bool bigEndian) const;
+
+	// Size of the Number
+	int  limbs() const { return length; }
+	int  bitCount() const;
+	int  byteCount() const;
+	bool isZero() const { return length == 0; }
+	bool isOdd() const { return length > 0 && (data[0] & 1); }
+	const limb* limbData() const { return data; }
+
+	// Relational Operators
+	int  compare(const BigNum &right) const;
+	bool operator>(const BigNum &right) const  { return compare(right) > 0; }
+	bool operator<(const BigNum &right) const  { return compare(right) < 0; }
+	bool operator==(const BigNum &right) const { return compare(right) == 0; }
+	bool operator>=(const BigNum &right) const { return compare(right) >= 0; }
+	bool operator<=(const BigNum &right) const { return compare(right) <= 0; }
+	bool operator!=(const BigNum &right) const { return compare(right) != 0; }
+
+	// Bitwise Operators
+	BigNum  operator<<(const int count) const;
+	BigNum  operator>>(const int count) const;
+	BigNum& operator<<=(const int count);
+	BigNum& operator>>=(const int count);
+
+	// Arithmetic Operators
+	BigNum  operator+(const BigNum &right) const;
+	BigNum  operator-(const BigNum &right) const;
+	BigNum  operator*(const BigNum &right) const;
+	BigNum  operator/(const BigNum &right) const;
+	BigNum  operator%(const BigNum &right) const;
+	BigNum& operator+=(const BigNum &right);
+	BigNum& operator-=(const BigNum &right);
+	BigNum& operator*=(const BigNum &right);
+	BigNum& operator/=(const BigNum &right);
+	BigNum& operator%=(const BigNum &right);
+
+	// Extra Arithmetic Functions
+	static void div(const BigNum &left, const BigNum &right, BigNum *qptr, BigNum *rptr);
+};
+
+#include "bignum.cpp"
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef ASN1_H
 #define ASN1_H
 
+#include <cstddef>
+
 // Writes a byte stream to a buffer in base64 format
 int writeBase64(const char* buffer, size_t bytes, char* string, size_t size);
 
@@ -13,4 +15,10 @@ int getInt(const char* buffer, size_t size, char* &intPtr, size_t &bytes);
 // Writes an integer in ANS1 format to a byte array
 int putInt(const char* val, size_t bytes, char* buffer, size_t size, bool bigEndian);
 
+// Gets a sequence from an ANS1 encoded stream
+int getSequence(const char* buffer, size_t size, char* &seqPtr, size_t &bytes);
+
+// Writes the header of a sequence in ANS1 format to the end of a byte array, in front of its content
+int putSequence(size_t content, char* buffer, size_t size);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef CHACHA20_H
+#define CHACHA20_H
+
+#include <cstddef>
+
+// ChaCha20 stream cipher (RFC 8439 2.4) with a 256 bit key, a 96 bit nonce
+// and a 32 bit block counter.
+class ChaCha20
+{
+private:
+	unsigned int state[16];
+
+public:
+	static const int keySize   = 32;
+	static const int nonceSize = 12;
+	static const int blockSize = 64;
+
+	ChaCha20(const unsigned char* key, const unsigned char* nonce, unsigned int counter = 0);
+
+	// Writes the key stream block of the counter and moves to the next block
+	void block(unsigned char* out);
+	// XORs len bytes of key stream onto in and writes them to out, which can be in.
+	// Every call starts at a new block, so only the last call can take a partial block.
+	void crypt(const unsigned char* in, unsigned char* out, size_t len);
+};
+
+// Poly1305 one-time authenticator (RFC 8439 2.5) with 26 bit limbs,
+// so the products fit into 64 bits on every platform.
+class Poly1305
+{
+private:
+	unsigned int r[5];
+	unsigned int h[5];
+	unsigned int pad[4];
+	unsigned char buffer[16];
+	size_t used;
+
+	void blocks(const unsigned char* data, size_t count, unsigned int hibit);
+
+public:
+	static const int keySize = 32;
+	static const int tagSize = 16;
+
+	// Takes a 32 byte one-time key
+	Poly1305(const unsigned char* key);
+
+	// Authenticates the next bytes of the message
+	void update(const void* data, size_t bytes);
+	// Writes the 16 byte tag of the message
+	void finish(unsigned char* tag);
+};
+
+// AEAD_CHACHA20_POLY1305 (RFC 8439 2.8). Encrypts len bytes of in into out, which can be in,
+// and writes the 16 byte tag of the additional data and the ciphertext.
+void chachaPolySeal(const unsigned char* key, const unsigned char* nonce,
+	const unsigned char* aad, size_t aadLen, const unsigned char* in, size_t len,
+	unsigned char* out, unsigned char* tag);
+
+// Checks the tag of the additional data and the ciphertext, then decrypts len bytes of in into out,
+// which can be in. Returns false and leaves out unchanged if the tag does not match.
+bool chachaPolyOpen(const unsigned char* key, const unsigned char* nonce,
+	const unsigned char* aad, size_t aadLen, const unsigned char* in, size_t len,
+	const unsigned char* tag, unsigned char* out);
+
+#endif
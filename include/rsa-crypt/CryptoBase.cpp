@@ -1,8 +1,15 @@
 
+// Odd moduli use r = 2^(size*64) and the word by word reduction, which only needs mod < r,
+// so a prime of any length up to N bytes gets the fast path. The size is the limb length of
+// the modulus, so a 1024 bit modulus in a 256 byte domain is reduced on 16 limbs, not 32.
+// Other moduli use r = 2^bitCount.
 template <unsigned int N>
-MontgomeryDomain<N>::MontgomeryDomain(const BigInt<N> &m)
+MontgomeryDomain<N>::MontgomeryDomain(const BigInt<N> &m, bool lazy)
 {
-	shift = m.bitCount();
+	size  = N % sizeof(limb) ? 0 : limb_length((const limb*)&m, N / sizeof(limb));
+	fast  = (m.bytes[0] & 1) != 0 && size > 0;
+	shift = fast ? size * LIMB_BITS : m.bitCount();
+	this->lazy = lazy && fast && m.bitCount() <= shift - 2;
 
 	memcpy(&mod, &m, N);
 	r = BigInt<N * 2>(1) << shift;
@@ -11,7 +18,10 @@ MontgomeryDomain<N>::MontgomeryDomain(const BigInt<N> &m)
 	mask = r;
 	mask--;
 
-	fast = (shift == (N * 8) ? true : false);
+	n0 = 0 - limb_inverse(*(limb*)&mod);
+
+	BigInt<N * 2> rm = r % mod;
+	R2 = slow_transform(BigInt<N>((void*)&rm));
 }
 
 template <unsigned int N>
@@ -24,14 +34,21 @@ BigInt<N * 2> MontgomeryDomain<N>::slow_transform(const BigInt<N> &val)
 	return temp % mod;
 }
 
+// Transforms a value with a Montgomery multiplication by r^2, val * r^2 / r = val * r.
+// The product must be below mod * r for the reduction to stay exact, so a value longer
+// than the modulus is reduced first.
 template <unsigned int N>
 BigInt<N * 2> MontgomeryDomain<N>::fast_transform(const BigInt<N> &val)
 {
 	BigInt<N * 2> temp;
 
-	memcpy((char*)&temp + N, &val, N);
-	memset(&temp, 0, N);
-	return temp % mod;
+	memcpy(&temp, &val, N);
+	memset((char*)&temp + N, 0, N);
+
+	if (limb_length((const limb*)&val, N / sizeof(limb)) > size)
+	{	temp %= mod;
+	}
+	return fast_multiply(temp, R2);
 }
 
 template <unsigned int N>
@@ -42,13 +59,24 @@ BigInt<N * 2> MontgomeryDomain<N>::transform(const BigInt<N> &val)
 template <unsigned int N>
 BigInt<N> MontgomeryDomain<N>::slow_revert(const BigInt<N * 2> &val)
 {
-	return BigInt<N>((void*)&multiply(BigInt<N*2>(val), BigInt<N * 2>(1)));
+	BigInt<N * 2> res = val;
+	BigInt<N * 2> one(1);
+	res = multiply(res, one);
+	return BigInt<N>((void*)&res);
 }
 
+// A lazy value below 2 * mod reverts to at most mod, so one subtraction makes it canonical
 template <unsigned int N>
 BigInt<N> MontgomeryDomain<N>::fast_revert(const BigInt<N * 2> &val)
 {
-	return BigInt<N>((void*)&fast_multiply(BigInt<N*2>(val), BigInt<N * 2>(1)));
+	BigInt<N * 2> res = val;
+	BigInt<N * 2> one(1);
+	fast_multiply(res, one);
+
+	if (lazy && res >= mod)
+	{	res -= mod;
+	}
+	return BigInt<N>((void*)&res);
 }
 
 template <unsigned int N>
@@ -60,7 +88,9 @@ BigInt<N> MontgomeryDomain<N>::revert(const BigInt<N * 2> &val)
 template <unsigned int N>
 BigInt<N * 2>& MontgomeryDomain<N>::slow_square(BigInt<N * 2> &num)
 {
-	char* x[N * 2], n[N * 2];
+	ScratchFrame frame(N * 4);
+	char* x = (char*)frame.data();
+	char* n = x + N * 2;
 	bool overflow = false;
 
 	//x = num * num;
@@ -95,41 +125,77 @@ BigInt<N * 2>& MontgomeryDomain<N>::slow_square(BigInt<N * 2> &num)
 	return num;
 }
 
+// Reduces the product limb by limb. m = t[i]*n0 makes the lowest limb 0 when m*mod is added,
+// so after size steps the upper half holds t/r which is less than 2*mod.
+// The carry out of the top limb is kept separately and the result is corrected with one
+// subtraction, after a comparison of the size low limbs from the top limb. In lazy mode the
+// operands are below 2*mod, the result is below 2*mod as well, and nothing is subtracted.
 template <unsigned int N>
-BigInt<N * 2>& MontgomeryDomain<N>::fast_square(BigInt<N * 2> &num)
+void MontgomeryDomain<N>::fast_reduce(BigInt<N * 2> &num)
 {
-	char* x[N * 2], n[N * 2];
-	bool overflow = false;
+	const int len = size;
+	limb* t = (limb*)&num;
+	const limb* n = (const limb*)&mod;
 
-	//x = num * num;
-	::square<N>((char*)&num);
-	memcpy(x, &num, N * 2);
+	limb top = 0;
+	for (int i = 0; i < len; i++)
+	{
+		limb c = limb_addmul(t + i, n, len, t[i] * n0);
+		limb s = t[i + len] + c;
+		limb o = s < c;
 
-	//s = ((x & mask)*R) & mask;
-	memset((char*)&num + N, 0, N);
-	karatsuba<N>((char*)&num, (char*)&R);
-	memset((char*)&num + N, 0, N);
+		t[i + len] = s + top;
+		top = o + (t[i + len] < s);
+	}
 
-	//t = (x + s*mod) >> shift;
-	karatsuba<N>((char*)&num, (char*)&mod);
-	memcpy(n, (char*)&num, N * 2);
-	num += *(BigInt<N * 2>*)x;
+	memcpy(t, t + len, len * sizeof(limb));
+	memset(t + len, 0, N * 2 - len * sizeof(limb));
 
-	if (num < *(BigInt<N * 2>*)x && num < *(BigInt<N * 2>*)n)
-	{	overflow = true;
+	if (!lazy && (top || limb_cmp(t, n, len) >= 0))
+	{	limb_sub(t, n, len);
 	}
+}
 
-	memcpy(&num, (char*)&num + N, N);
-	memset((char*)&num + N, 0, N);
+// Squares a number in the Montgomery domain and reduces it without intermediate multiplications.
+// Moduli above BIGINT_KARATSUBA_SQR_THRESHOLD limbs are squared by limb_sqr, which picks
+// Karatsuba or Toom-3 from the length, and only the reduction is done here. Below that,
+// the operand is copied to the scratch arena of the thread and squared into num.
+// [1] Every product a[i]*a[j] with i<j is calculated once into the 2N byte result.
+// [2] The off-diagonal sum is doubled and the squares a[i]*a[i] are added in a single pass,
+//     the bit shifted out of each limb is carried in the high limb of the multiplication by 2.
+template <unsigned int N>
+BigInt<N * 2>& MontgomeryDomain<N>::fast_square(BigInt<N * 2> &num)
+{
+	const int len = size;
+	limb* t = (limb*)&num;
 
-	if (overflow)
-	{	*((char*)&num + N) = 1;
+	if (len > BIGINT_KARATSUBA_SQR_THRESHOLD)
+	{	::square<N>((char*)&num);
+		fast_reduce(num);
+		return num;
 	}
 
-	if (num >= mod)
-	{	num -= mod;
+	ScratchFrame frame(len * sizeof(limb));
+	limb* a = (limb*)frame.data();
+
+	memcpy(a, t, len * sizeof(limb));
+	memset(t, 0, N * 2);
+
+// [1]
+	for (int i = 0; i < len - 1; i++)
+	{	t[i + len] = limb_addmul(t + i + i + 1, a + i + 1, len - i - 1, a[i]);
 	}
 
+// [2]
+	limb carry = 0, hi;
+	for (int i = 0; i < len; i++)
+	{
+		limb lo = limb_mac(a[i], a[i], 0, 0, hi);
+		t[i + i]     = limb_mac(t[i + i], 2, lo, carry, carry);
+		t[i + i + 1] = limb_mac(t[i + i + 1], 2, hi, carry, carry);
+	}
+
+	fast_reduce(num);
 	return num;
 }
 
@@ -141,7 +207,8 @@ BigInt<N * 2> MontgomeryDomain<N>::square(BigInt<N * 2> &num)
 template <unsigned int N>
 BigInt<N * 2>& MontgomeryDomain<N>::slow_multiply(BigInt<N * 2> &left, BigInt<N * 2> &right)
 {
-	char* x[N * 2];
+	ScratchFrame frame(N * 2);
+	char* x = (char*)frame.data();
 
 	//x = left * right;
 	karatsuba<N>((char*)&left, (char*)&right);
@@ -165,41 +232,13 @@ BigInt<N * 2>& MontgomeryDomain<N>::slow_multiply(BigInt<N * 2> &left, BigInt<N
 	return left;
 }
 
+// The product of the operands takes the 2N bytes of left and is reduced in place, so the
+// multiplication by R and the overflow checks of the slow path are not needed.
 template <unsigned int N>
 BigInt<N * 2>& MontgomeryDomain<N>::fast_multiply(BigInt<N * 2> &left, BigInt<N * 2> &right)
 {
-	char* x[N * 2], n[N * 2];
-	bool overflow = false;
-
-	//x = left * right;
 	karatsuba<N>((char*)&left, (char*)&right);
-	memcpy(x, &left, N * 2);
-
-	//s = ((x & mask)*R) & mask;
-	memset((char*)&left + N, 0, N);
-	karatsuba<N>((char*)&left, (char*)&R);
-	memset((char*)&left + N, 0, N);
-
-	//t = (x + s*mod) >> shift;
-	karatsuba<N>((char*)&left, (char*)&mod);
-	memcpy(n, (char*)&left, N * 2);
-	left += *(BigInt<N * 2>*)x;
-
-	if (left < *(BigInt<N * 2>*)x && left < *(BigInt<N * 2>*)n)
-	{	overflow = true;
-	}
-
-	memcpy(&left, (char*)&left + N, N);
-	memset((char*)&left + N, 0, N);
-
-	if (overflow)
-	{	*((char*)&left + N) = 1;
-	}
-
-	if (left >= mod)
-	{	left -= mod;
-	}
-
+	fast_reduce(left);
 	return left;
 }
 
@@ -209,65 +248,53 @@ BigInt<N * 2> MontgomeryDomain<N>::multiply(BigInt<N * 2> &left, BigInt<N * 2> &
 }
 
 template <unsigned int N>
-BigInt<N> crypto_gcd(BigInt<N> a, BigInt<N> b)
+BigInt<N> crypto_gcd(const BigInt<N> &a, const BigInt<N> &b)
 {
-	BigInt<N> temp;
-
-	if (a > b)
-	{
-		temp = a;
-		a = b;
-		b = temp;
+	BigInt<N> quotient;
+	BigInt<N> rem[2] = { a > b ? a : b, a > b ? b : a };
+	int k = 0;
+
+	// The remainder replaces the dividend, and the divisor becomes the next dividend
+	while (!rem[k ^ 1].isZero())
+	{	BigInt<N>::div(rem[k], rem[k ^ 1], &quotient, &rem[k]);
+		k ^= 1;
 	}
 
-	while (true)
-	{
-		BigInt<N>::div(b, a, &b, &temp);
-
-		if (temp.isZero())
-		{	return a;
-		}
-
-		b = a;
-		a = temp;
-
-	}
+	return rem[k];
 }
 
 template <unsigned int N>
-BigInt<N> crypto_inverse(BigInt<N> x, BigInt<N> mod)
+BigInt<N> crypto_inverse(const BigInt<N> &x, const BigInt<N> &mod)
 {
 	int ctr = 0;
-	BigInt<N> p2;
-	BigInt<N> p1 = 1;
-	BigInt<N> p0 = 1;
-
-	BigInt<N> temp;
-	BigInt<N> original = mod;
-
+	const BigInt<N> one(1);
+	BigInt<N> quotient;
+	BigInt<N> rem[2] = { mod, x };
+	BigInt<N> coef[2] = { BigInt<N>(), one };
+	int k = 0, c = 1;
+
+	// Same steps as crypto_gcd. The coefficients also take turns: the previous one
+	// gets the product of the current one and the quotient added, and becomes current.
 	while (true)
 	{
-		BigInt<N>::div(mod, x, &mod, &temp);
+		BigInt<N>::div(rem[k], rem[k ^ 1], &quotient, &rem[k]);
 
-		if (temp.isZero())
+		if (rem[k].isZero())
 		{
-			if (x != "1")
-			{	return temp;
+			if (rem[k ^ 1] != one)
+			{	return rem[k];
 			} 
 			else if (ctr & 1)
-			{	return original - p0;
+			{	return mod - coef[c];
 			}
 			else
-			{	return p0;
+			{	return coef[c];
 			}
 		}
 
-		p0 = p0 * mod + p2;
-		p2 = p1;
-		p1 = p0;
-
-		mod = x;
-		x = temp;
+		coef[c ^ 1].mulAdd(coef[c], quotient);
+		c ^= 1;
+		k ^= 1;
 		ctr++;
 	}
 }
@@ -297,4 +324,156 @@ void crypto_pow(BigInt<N * 2> &x, BigInt<N> &exp, MontgomeryDomain<N> &dom)
 			end--;
 		}
 	}
-}
\ No newline at end of file
+}
+
+// Raises x to a machine word exponent from its highest set bit, so e = 65537 takes
+// 16 squarings and 1 multiplication. The exponent must not be 0.
+template <unsigned int N>
+void crypto_pow(BigInt<N * 2> &x, unsigned long long exp, MontgomeryDomain<N> &dom)
+{
+	BigInt<N * 2> num = x;
+	int bit = 63;
+
+	while (bit > 0 && !(exp >> bit))
+		bit--;
+
+	for (bit--; bit >= 0; bit--)
+	{
+		dom.square(x);
+
+		if ((exp >> bit) & 1)
+		{	dom.multiply(x, num);
+		}
+	}
+}
+
+// [1] The window grows with the exponent: a window of w bits needs 2^(w-1) - 1 products for
+//     the odd powers, and saves about bits/(w+1) products over one multiplication per set bit.
+// [2] From the top, zero bits only add squarings. A set bit starts a window of up to w bits
+//     that ends with a set bit, so its value is odd. The squarings of the zeros before it
+//     and of its own bits are done before its multiplication.
+// [3] The zeros after the last window are squarings without a multiplication.
+template <unsigned int N>
+RecodedExponent crypto_recode(const BigInt<N> &exp)
+{
+	RecodedExponent res;
+	int bits = exp.bitCount();
+
+// [1]
+	res.window = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+
+// [2]
+	int zeros = 0;
+	for (int i = bits - 1; i >= 0;)
+	{
+		if (!((exp.bytes[i / 8] >> (i % 8)) & 1))
+		{	zeros++;
+			i--;
+			continue;
+		}
+
+		int j = i - res.window + 1 < 0 ? 0 : i - res.window + 1;
+		while (!((exp.bytes[j / 8] >> (j % 8)) & 1))
+		{	j++;
+		}
+
+		ExponentStep step;
+		step.squares = (unsigned short)(res.steps.empty() ? 0 : zeros + i - j + 1);
+		step.digit = 0;
+		for (int k = i; k >= j; k--)
+		{	step.digit = (unsigned short)((step.digit << 1) | ((exp.bytes[k / 8] >> (k % 8)) & 1));
+		}
+
+		res.steps.push_back(step);
+		zeros = 0;
+		i = j - 1;
+	}
+
+// [3]
+	if (zeros)
+	{	ExponentStep step = { (unsigned short)zeros, 0 };
+		res.steps.push_back(step);
+	}
+
+	return res;
+}
+
+// The odd powers x, x^3, ... x^(2^window - 1) are kept in scratch memory. The first step
+// starts from its power, so the exponent needs no scanning and the loop has no bit tests.
+template <unsigned int N>
+void crypto_pow(BigInt<N * 2> &x, const RecodedExponent &exp, MontgomeryDomain<N> &dom)
+{
+	if (exp.steps.empty())
+	{	x = dom.transform(1);
+		return;
+	}
+
+	int entries = 1 << (exp.window - 1);
+	ScratchFrame frame(sizeof(BigInt<N * 2>) * (entries + 1));
+	BigInt<N * 2>* table  = (BigInt<N * 2>*)frame.data();
+	BigInt<N * 2>& square = table[entries];
+
+	table[0] = x;
+	square = x;
+	dom.square(square);
+	for (int i = 1; i < entries; i++)
+	{	table[i] = table[i - 1];
+		dom.multiply(table[i], square);
+	}
+
+	const ExponentStep* step = exp.steps.data();
+	const ExponentStep* end  = step + exp.steps.size();
+
+	x = table[step->digit >> 1];
+	for (step++; step != end; step++)
+	{
+		for (int i = 0; i < step->squares; i++)
+		{	dom.square(x);
+		}
+		if (step->digit)
+		{	dom.multiply(x, table[step->digit >> 1]);
+		}
+	}
+}
+
+// Raises x to exp in a Montgomery domain of N bytes, with the exponent recoded into windows.
+template <unsigned int N>
+BigNum crypto_pow_of(const BigNum &x, const BigNum &exp, const BigNum &mod)
+{
+	BigInt<N> m, e, base;
+	mod.toBigInt(m);
+	exp.toBigInt(e);
+	(x % mod).toBigInt(base);
+
+	MontgomeryDomain<N> dom(m);
+	BigInt<N * 2> res = dom.transform(base);
+	crypto_pow(res, crypto_recode(e), dom);
+
+	return BigNum(dom.revert(res));
+}
+
+// The domain is picked from the length of the modulus and the exponent, so a 1024 bit
+// modulus runs on the kernels of BigInt<128>, and a 4096 bit one on those of BigInt<512>.
+// The Montgomery domain needs an odd modulus, an even one or 0 throws -1, like a modulus
+// or an exponent over 8192 bits.
+inline BigNum crypto_pow(const BigNum &x, const BigNum &exp, const BigNum &mod)
+{
+	if (!mod.isOdd())
+	{	throw -1;
+	}
+
+	int bytes = mod.byteCount() > exp.byteCount() ? mod.byteCount() : exp.byteCount();
+
+	if (bytes <= 64)
+		return crypto_pow_of<64>(x, exp, mod);
+	if (bytes <= 128)
+		return crypto_pow_of<128>(x, exp, mod);
+	if (bytes <= 256)
+		return crypto_pow_of<256>(x, exp, mod);
+	if (bytes <= 512)
+		return crypto_pow_of<512>(x, exp, mod);
+	if (bytes <= 1024)
+		return crypto_pow_of<1024>(x, exp, mod);
+
+	throw -1;
+}
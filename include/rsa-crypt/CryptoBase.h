@@ -2,6 +2,8 @@
 #define CRYPTOBASE_H
 
 #include <bigint/bigint.h>
+#include <bigint/bignum.h>
+#include <vector>
 
 template <unsigned int N>
 class MontgomeryDomain
@@ -11,16 +13,34 @@ public:
 	BigInt<N * 2> r;
 	BigInt<N * 2> R;
 
+	// r^2 modulo mod, transforms a value with one Montgomery multiplication
+	BigInt<N * 2> R2;
+
 	BigInt<N * 2> mask;
 	int shift;
 
+	// -mod^-1 modulo the limb size, for the word by word reduction
+	limb n0;
+
+	// Limbs of the modulus, the fast path works on this many limbs instead of N bytes
+	int size;
+
 	bool fast;
 
+	// Results of square and multiply are only reduced below 2 * mod (almost Montgomery form),
+	// which takes 4 * mod < r. Such values must be reverted before they are compared.
+	bool lazy;
+
+private:
+	// Word by word Montgomery reduction of a 2N byte product in place
+	void fast_reduce(BigInt<N * 2> &num);
+
 public:
 	MontgomeryDomain(){}
 	
-	// Creates a Montgomery domain and its signature values
-	MontgomeryDomain(const BigInt<N> &m);
+	// Creates a Montgomery domain and its signature values. Lazy reduction is used
+	// if it is asked for and the modulus leaves the 2 top bits of r free.
+	MontgomeryDomain(const BigInt<N> &m, bool lazy = false);
 
 	// Transforms a normal value into Montgomery domain
 	BigInt<N * 2> slow_transform(const BigInt<N> &val);
@@ -43,18 +63,50 @@ public:
 	BigInt<N * 2> multiply(BigInt<N * 2> &left, BigInt<N * 2> &right);
 };
 
+// One step of a recoded exponent: square squares times, then multiply by the
+// odd power digit of the base, or by nothing if digit is 0
+struct ExponentStep
+{
+	unsigned short squares;
+	unsigned short digit;
+};
+
+// Exponent recoded into sliding windows of at most window bits, for exponents
+// that are used many times, like the private exponents of a key
+struct RecodedExponent
+{
+	int window;
+	std::vector<ExponentStep> steps;
+};
+
 // Calculates the GCD of 2 numbers
 template <unsigned int N>
-BigInt<N> crypto_gcd(BigInt<N> a, BigInt<N> b);
+BigInt<N> crypto_gcd(const BigInt<N> &a, const BigInt<N> &b);
 
 // Calculates the Modular Multiplicative Inverse of a number
 template <unsigned int N>
-BigInt<N> crypto_inverse(BigInt<N> x, BigInt<N> mod);
+BigInt<N> crypto_inverse(const BigInt<N> &x, const BigInt<N> &mod);
 
 // Modular Exponentiation of a number using a Montgomery Domain
 template <unsigned int N>
 void crypto_pow(BigInt<N * 2> &x, BigInt<N> &exp, MontgomeryDomain<N> &dom);
 
+// Modular Exponentiation of a number by a machine word exponent using a Montgomery Domain
+template <unsigned int N>
+void crypto_pow(BigInt<N * 2> &x, unsigned long long exp, MontgomeryDomain<N> &dom);
+
+// Recodes an exponent into sliding windows, with a window size that suits its length
+template <unsigned int N>
+RecodedExponent crypto_recode(const BigInt<N> &exp);
+
+// Modular Exponentiation by a recoded exponent using a Montgomery Domain
+template <unsigned int N>
+void crypto_pow(BigInt<N * 2> &x, const RecodedExponent &exp, MontgomeryDomain<N> &dom);
+
+// Modular Exponentiation of Big Numbers up to 8192 bits, in the Montgomery domain of the
+// smallest Big Integer that holds the modulus
+inline BigNum crypto_pow(const BigNum &x, const BigNum &exp, const BigNum &mod);
+
 #include "CryptoBase.cpp"
 
 #endif
\ No newline at end of file
@@ -16,24 +16,10 @@ static int primesList[] =
 
 template <unsigned int N>
 int shiftCount(const BigInt<N> &prime)
-{
-	unsigned char* start = (unsigned char*)&prime;
-	unsigned char  mask = 1;
-	int count = 0;
-
-	while (*start == 0)
-	{	count += 8;
-		start++;
-	}
-
-	while (!(*start & mask))
-	{	count++;
-		mask <<= 1;
-	}
-
-	return count;
+{	return prime.zeroCount();
 }
 
+// Trial division by the listed primes. A listed prime itself is only divisible by itself.
 template <unsigned int N>
 bool isPrimeFast(const BigInt<N> &prime)
 {
@@ -43,13 +29,53 @@ bool isPrimeFast(const BigInt<N> &prime)
 	{	
 		*(int*)&small = primesList[i];
 		if ((prime % small).isZero())
-		{	return false;
+		{	return prime == small;
         }
 	}
 
 	return true;
 }
 
+// Minimum Miller Rabin rounds for an error probability below 2^-100 on a randomly chosen
+// candidate of at least the given bits (FIPS 186-4 Table C.2 from 512 bits, Damgard,
+// Landrock and Pomerance below). The bound does not hold for numbers picked by an adversary.
+static const int primeRoundsTable[][2] =
+{	{1536, 3}, {1024, 4}, {512, 7}, {256, 16}, {0, 40}
+};
+
+inline int primeRounds(int bits)
+{
+	int i = 0;
+	while (bits < primeRoundsTable[i][0])
+	{	i++;
+	}
+	return primeRoundsTable[i][1];
+}
+
+// Raises 2 to exp in the Montgomery domain. The multiplication by the base is a doubling,
+// a shift and at most one subtraction, so only the squarings are Montgomery products.
+template <unsigned int N>
+BigInt<N * 2> crypto_pow2(const BigInt<N> &exp, MontgomeryDomain<N> &dom)
+{
+	BigInt<N * 2> x = dom.transform(2);
+
+	for (int i = exp.bitCount() - 2; i >= 0; i--)
+	{
+		dom.square(x);
+
+		if ((exp.bytes[i / 8] >> (i % 8)) & 1)
+		{	x <<= 1;
+			if (x >= dom.mod)
+			{	x -= dom.mod;
+			}
+		}
+	}
+
+	return x;
+}
+
+// The first round uses the base 2, the rest use random bases from 2 to prime - 2.
+// Most composites fail the first round, which needs no general multiplications.
 template <unsigned int N>
 bool isPrimeMR(const BigInt<N> &prime, int precision)
 {
@@ -60,14 +86,21 @@ bool isPrimeMR(const BigInt<N> &prime, int precision)
 	BigInt<N * 2> mOne = domain.transform(m);
 	BigInt<N * 2> one = domain.transform(1);
 	BigInt<N * 2> a;
+	BigInt<N> range = prime - BigInt<N>(3);
 
+	int rounds = precision > 0 ? precision : primeRounds(prime.bitCount());
 	int k = shiftCount(m);
 	m >>= k;
 
-	for (int ctr = 0, i = 2; i < precision + 2; i++)
+	for (int ctr = 0, i = 0; i < rounds; i++)
 	{
-		a = domain.transform(i);
-		crypto_pow(a, m, domain);
+		if (i == 0)
+		{	a = crypto_pow2(m, domain);
+		}
+		else
+		{	a = domain.transform(crypto_rand<N>() % range + BigInt<N>(2));
+			crypto_pow(a, m, domain);
+		}
 
 		if (a != mOne && a != one)
 		{
@@ -84,15 +117,237 @@ bool isPrimeMR(const BigInt<N> &prime, int precision)
 	return true;
 }
 
+// Remainder of a Big Integer by a small number, one byte at a time from the top
+template <unsigned int N>
+unsigned int smallMod(const BigInt<N> &num, unsigned int m)
+{
+	unsigned long long rem = 0;
+
+	for (int i = N - 1; i >= 0; i--)
+	{	rem = ((rem << 8) | num.bytes[i]) % m;
+	}
+	return (unsigned int)rem;
+}
+
+// Jacobi symbol (a/n) of machine words for an odd n
+inline int jacobi(unsigned long long a, unsigned long long n)
+{
+	int res = 1;
+
+	for (a %= n; a != 0; a %= n)
+	{
+		while (!(a & 1))
+		{	a >>= 1;
+			if ((n & 7) == 3 || (n & 7) == 5)
+				res = -res;
+		}
+
+		std::swap(a, n);
+		if ((a & 3) == 3 && (n & 3) == 3)
+			res = -res;
+	}
+
+	return n == 1 ? res : 0;
+}
+
+// Newton's method from a start above the root, the estimate falls until it reaches floor(sqrt)
+template <unsigned int N>
+bool isSquare(const BigInt<N> &num)
+{
+	BigInt<N> x = BigInt<N>(1) << ((num.bitCount() + 1) / 2);
+	BigInt<N> y;
+
+	while (true)
+	{
+		y = (x + num / x) >> 1;
+		if (y >= x) break;
+		x = y;
+	}
+
+	return num / x == x && (num % x).isZero();
+}
+
+// Values of the Lucas test are kept in the Montgomery domain, below the modulus. Odd moduli of
+// whole limbs have the limb length of the modulus in the domain, and the values are added and
+// subtracted on those limbs like in fast_reduce. Other moduli use the operators of the numbers.
 template <unsigned int N>
-bool isPrime(const BigInt<N> &prime, int precision = 50)
-{	return isPrimeFast(prime) && isPrimeMR(prime, precision);
+void montAdd(BigInt<N * 2> &x, const BigInt<N * 2> &y, const MontgomeryDomain<N> &domain)
+{
+	if (!domain.fast)
+	{	x += y;
+		if (x >= domain.mod)
+		{	x -= domain.mod;
+		}
+		return;
+	}
+
+	limb* a = (limb*)&x;
+	const limb* n = (const limb*)&domain.mod;
+
+	if (limb_add(a, (const limb*)&y, domain.size) || limb_cmp(a, n, domain.size) >= 0)
+	{	limb_sub(a, n, domain.size);
+	}
 }
 
 template <unsigned int N>
-void genratePrime(BigInt<N> &prime, int precision = 50)
+void montSub(BigInt<N * 2> &x, const BigInt<N * 2> &y, const MontgomeryDomain<N> &domain)
 {
-	prime = rand<N>();
+	if (!domain.fast)
+	{	if (x < y)
+		{	x += domain.mod;
+		}
+		x -= y;
+		return;
+	}
+
+	limb* a = (limb*)&x;
+	if (limb_sub(a, (const limb*)&y, domain.size))
+	{	limb_add(a, (const limb*)&domain.mod, domain.size);
+	}
+}
+
+// -x is 0 - x, so 0 stays 0
+template <unsigned int N>
+void montNeg(BigInt<N * 2> &x, const MontgomeryDomain<N> &domain)
+{
+	BigInt<N * 2> res;
+	montSub(res, x, domain);
+	x = res;
+}
+
+// x / 2 is x * (mod + 1) / 2, so an odd x gets the modulus added before the shift.
+// The carry out of that addition is shifted back into the top limb.
+template <unsigned int N>
+void montHalf(BigInt<N * 2> &x, const MontgomeryDomain<N> &domain)
+{
+	if (!domain.fast)
+	{	if (x.bytes[0] & 1)
+		{	x += domain.mod;
+		}
+		x >>= 1;
+		return;
+	}
+
+	limb* a = (limb*)&x;
+	limb carry = 0;
+
+	if (a[0] & 1)
+	{	carry = limb_add(a, (const limb*)&domain.mod, domain.size);
+	}
+	limb_shr(a, a, domain.size, 1);
+	a[domain.size - 1] |= carry << (LIMB_BITS - 1);
+}
+
+// Strong Lucas probable prime test with the parameters of Selfridge's method A (FIPS 186-4 C.3.3).
+// [1] D is the first of 5, -7, 9, -11, ... with (D/prime) = -1, P = 1 and Q = (1 - D) / 4.
+//     (D/prime) = (prime mod |D| / |D|) by reciprocity, with a sign flip when both are 3 mod 4
+//     and another for a negative D when prime is 3 mod 4. A square has no such D, so it is
+//     ruled out if the first few do not work.
+// [2] prime + 1 = d * 2^s. U_d and V_d are built from the top bit of d with
+//     U_2k = U_k * V_k, V_2k = V_k^2 - 2Q^k, U_k+1 = (U_k + V_k) / 2, V_k+1 = (D * U_k + V_k) / 2.
+// [3] prime passes if U_d = 0 or V_(d * 2^r) = 0 for some r < s.
+template <unsigned int N>
+bool isPrimeLucas(const BigInt<N> &prime)
+{
+// [1]
+	long long D = 5;
+	int res;
+	int p4 = smallMod(prime, 4);
+
+	for (int i = 0;; i++)
+	{
+		unsigned int a = (unsigned int)(D < 0 ? -D : D);
+		res = jacobi(smallMod(prime, a), a);
+		if ((a & 3) == 3 && p4 == 3) res = -res;
+		if (D < 0 && p4 == 3)        res = -res;
+
+		if (res == -1) break;
+		if (res == 0 && prime != BigInt<N>(a)) return false;
+		if (i == 10 && isSquare(prime)) return false;
+
+		D = D < 0 ? 2 - D : -2 - D;
+	}
+
+	MontgomeryDomain<N> domain(prime);
+	long long Q = (1 - D) / 4;
+
+	BigInt<N * 2> zero;
+	BigInt<N * 2> d = domain.transform(BigInt<N>((unsigned long long)(D < 0 ? -D : D)));
+	BigInt<N * 2> q = domain.transform(BigInt<N>((unsigned long long)(Q < 0 ? -Q : Q)));
+	if (D < 0) montNeg(d, domain);
+	if (Q < 0) montNeg(q, domain);
+
+// [2]
+	BigInt<N> k = prime;
+	k += 1;
+	if (k.isZero()) return false;
+
+	int s = shiftCount(k);
+	k >>= s;
+
+	BigInt<N * 2> U  = domain.transform(1);
+	BigInt<N * 2> V  = U;
+	BigInt<N * 2> Qk = q;
+	BigInt<N * 2> t;
+
+	for (int i = k.bitCount() - 2; i >= 0; i--)
+	{
+		domain.multiply(U, V);
+		domain.square(V);
+		montSub(V, Qk, domain);
+		montSub(V, Qk, domain);
+		domain.square(Qk);
+
+		if ((k.bytes[i / 8] >> (i % 8)) & 1)
+		{
+			t = U;
+			domain.multiply(t, d);
+			montAdd(t, V, domain);
+			montAdd(U, V, domain);
+			montHalf(U, domain);
+			montHalf(t, domain);
+			V = t;
+			domain.multiply(Qk, q);
+		}
+	}
+
+// [3]
+	if (U == zero || V == zero)
+		return true;
+
+	for (int r = 1; r < s; r++)
+	{
+		domain.square(V);
+		montSub(V, Qk, domain);
+		montSub(V, Qk, domain);
+		if (V == zero)
+			return true;
+		domain.square(Qk);
+	}
+
+	return false;
+}
+
+// Baillie-PSW: a base 2 strong test and a strong Lucas test. No composite is known to pass both,
+// and none exists below 2^64.
+template <unsigned int N>
+bool isPrimeBPSW(const BigInt<N> &prime)
+{	return isPrimeFast(prime) && isPrimeMR(prime, 1) && isPrimeLucas(prime);
+}
+
+template <unsigned int N>
+bool isPrime(const BigInt<N> &prime, int precision)
+{
+	if (precision == PRIME_BPSW)
+		return isPrimeBPSW(prime);
+
+	return isPrimeFast(prime) && isPrimeMR(prime, precision);
+}
+
+template <unsigned int N>
+void genratePrime(BigInt<N> &prime, int precision)
+{
+	prime = crypto_rand<N>();
 
 	((char*)&prime)[0]   |= 1;
     ((char*)&prime)[N-1] |= 128;
@@ -102,4 +357,25 @@ void genratePrime(BigInt<N> &prime, int precision = 50)
 		{	break;
 		}
 	}
-}
\ No newline at end of file
+}
+
+// Generates a prime of bits bits (at most N * 8) with its top 3 bits set. The product of
+// up to 4 such primes is at least 0.875^4 > 1/2 of 2^(sum of the bits), so it has all the bits.
+template <unsigned int N>
+void randomPrime(BigInt<N> &prime, int bits, int precision)
+{
+	int top = bits - 1;
+
+	prime = crypto_rand<N>();
+	memset(prime.bytes + top / 8 + 1, 0, N - top / 8 - 1);
+	prime.bytes[top / 8] &= 0xFF >> (7 - top % 8);
+
+	for (int i = 0; i < 3; i++)
+	{	prime.bytes[(top - i) / 8] |= 1 << ((top - i) % 8);
+	}
+	prime.bytes[0] |= 1;
+
+	while (!isPrime(prime, precision))
+	{	prime += 2;
+	}
+}
@@ -2,6 +2,11 @@
 #define CRYPTOPRIME_H
 
 #include "CryptoBase.h"
+#include "CryptoRandom.h"
+
+// Precision values that pick the test instead of a number of Miller Rabin rounds
+#define PRIME_ROUNDS_AUTO  0	// rounds from the bit size, see primeRounds
+#define PRIME_BPSW        -1	// Baillie-PSW
 
 template <unsigned int N>
 int shiftCount(const BigInt<N> &prime);
@@ -10,13 +15,32 @@ int shiftCount(const BigInt<N> &prime);
 template <unsigned int N>
 bool isPrimeFast(const BigInt<N> &prime);
 
+// Number of miller rabin rounds needed for random candidates of the given size
+inline int primeRounds(int bits);
+
 // Probabilistic slow prime checking using miller rabin algorithm
 template <unsigned int N>
 bool isPrimeMR(const BigInt<N> &prime, int precision);
 
+// Probabilistic prime checking using the strong lucas test
+template <unsigned int N>
+bool isPrimeLucas(const BigInt<N> &prime);
+
+// Baillie-PSW prime checking
+template <unsigned int N>
+bool isPrimeBPSW(const BigInt<N> &prime);
+
 // Main primality testing function
 template <unsigned int N>
-bool isPrime(const BigInt<N> &prime, int precision);
+bool isPrime(const BigInt<N> &prime, int precision = PRIME_ROUNDS_AUTO);
+
+// Generates a random prime of N bytes with the top bit set
+template <unsigned int N>
+void genratePrime(BigInt<N> &prime, int precision = PRIME_ROUNDS_AUTO);
+
+// Generates a random prime of the given number of bits, with the top 3 bits set
+template <unsigned int N>
+void randomPrime(BigInt<N> &prime, int bits, int precision = PRIME_ROUNDS_AUTO);
 
 #include "CryptoPrime.cpp"
 
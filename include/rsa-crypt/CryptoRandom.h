@@ -0,0 +1,21 @@
+#ifndef CRYPTORANDOM_H
+#define CRYPTORANDOM_H
+
+#include <bigint/bigint.h>
+#include <cstddef>
+
+// Fills len bytes from the ChaCha20 generator of the calling thread. Every thread has its
+// own generator, seeded from the operating system on first use, so threads never wait
+// for each other.
+void crypto_random(void* out, size_t len);
+
+// Random Big Integer from the generator of the calling thread
+template <unsigned int N>
+BigInt<N> crypto_rand()
+{
+	BigInt<N> res;
+	crypto_random(res.bytes, N);
+	return res;
+}
+
+#endif
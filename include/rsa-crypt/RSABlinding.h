@@ -0,0 +1,51 @@
+#ifndef RSABLINDING_H
+#define RSABLINDING_H
+
+#include "CryptoBase.h"
+#include <atomic>
+
+// Number of blinding pairs kept per key
+#define RSA_BLINDING_SLOTS 16
+
+// Blinds private key operations with pairs of r^e and r^-1 modulo n. A pair is only
+// computed once per slot; every use squares both values, which gives the pair of r^2.
+// The pairs are in the Montgomery form of the modulus, so one Montgomery multiplication
+// of a normal number by a factor gives the normal product.
+// Slots are taken with a compare and swap, so threads never wait for each other.
+class RSABlinding
+{
+private:
+	struct Slot
+	{
+		std::atomic<bool> busy;
+		bool ready;
+		BigInt<512> factor;		// r^e
+		BigInt<512> inverse;	// r^-1
+	};
+
+	MontgomeryDomain<256> domain;
+	BigInt<256> modulus;
+	BigInt<256> publicExponent;
+	unsigned long long exponent;
+
+	Slot slots[RSA_BLINDING_SLOTS];
+	std::atomic<unsigned int> start;
+
+	void create(BigInt<512> &factor, BigInt<512> &inverse);
+	void next(BigInt<512> &factor, BigInt<512> &inverse);
+
+public:
+	// Takes the domain of the modulus, the public exponent, and the exponent
+	// as a machine word or 0 if it does not fit into one
+	RSABlinding(const MontgomeryDomain<256> &domain, const BigInt<256> &publicExponent, unsigned long long exponent);
+
+	RSABlinding(const RSABlinding&) = delete;
+	RSABlinding& operator=(const RSABlinding&) = delete;
+
+	// Multiplies data by r^e of the next pair and keeps r^-1 for unblind
+	BigInt<256> blind(const BigInt<256> &data, BigInt<512> &inverse);
+	// Multiplies the result of the private key operation by r^-1
+	BigInt<256> unblind(const BigInt<256> &data, BigInt<512> &inverse);
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef RSAENVELOPE_H
+#define RSAENVELOPE_H
+
+#include "RSAcipher.h"
+#include "ChaCha20.h"
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// Encrypts payloads of any size for the owner of an RSA key. A random number is encrypted
+// with the public key once (RSA-KEM), the data key is derived from it with SHA-256, and
+// the payload is encrypted in chunks with ChaCha20-Poly1305. The chunks of a batch are
+// encrypted on worker threads while the next batch is read and the previous one is written.
+class RSAEnvelope
+{
+private:
+	// Chunks read from the stream, each in a slot of chunkSize + tag bytes
+	struct Batch
+	{
+		std::vector<unsigned char> data;
+		std::vector<size_t> lengths;
+		unsigned long long first;
+		int count;
+		bool last;
+	};
+
+	RSACipher& cipher;
+	size_t chunkSize;
+	int threads;
+
+	bool read(std::istream &in, Batch &batch, size_t chunk, size_t readSize);
+	bool process(Batch &batch, bool seal, const unsigned char* key, const std::vector<unsigned char> &header, size_t chunk);
+	bool run(std::istream &in, std::ostream &out, bool seal, const unsigned char* key, const std::vector<unsigned char> &header, size_t chunk);
+
+public:
+	static const int version = 1;
+	static const int tagSize = Poly1305::tagSize;
+	static const size_t maxChunkSize = 1 << 24;
+
+	// Creates an envelope for the key of the cipher with the size of the chunks (for seal)
+	// and the number of threads that encrypt or decrypt the chunks
+	RSAEnvelope(RSACipher &cipher, size_t chunkSize = 65536, int threads = 1);
+
+	// Encrypts everything read from in with the public key and writes the container to out.
+	// Returns false if the key is too small or out fails.
+	bool seal(std::istream &in, std::ostream &out);
+	// Decrypts a container read from in with the private key and writes the payload to out.
+	// Chunks are written as they are authenticated, so the payload is only complete
+	// when true is returned. Returns false if the container is invalid or was modified.
+	bool open(std::istream &in, std::ostream &out);
+};
+
+#endif
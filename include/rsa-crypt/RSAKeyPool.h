@@ -0,0 +1,65 @@
+#ifndef RSAKEYPOOL_H
+#define RSAKEYPOOL_H
+
+#include "RSAcipher.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counters of the key pool since it was created
+struct RSAKeyPoolStats
+{
+	unsigned long long generated;	// Keys made by the background threads
+	unsigned long long taken;		// Keys taken from the pool
+	unsigned long long misses;		// Keys made by the caller because the pool was empty
+};
+
+// Keeps generated private keys ready for each number of primes. Background threads at
+// the lowest priority make keys until every count is at its capacity again, so taking
+// a key costs as much as taking it off a queue.
+class RSAKeyPool
+{
+private:
+	static const int kinds = RSA_MAX_GENERATED_PRIMES - 1;
+
+	std::deque<RSAPrivateKey> keys[kinds];
+	int capacity[kinds];
+	int pending[kinds];
+
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable signal;
+	bool stopping;
+
+	RSAKeyPoolStats counters;
+
+	// Gets the kind that is furthest below its capacity, -1 if none is
+	int needed() const;
+	void run();
+
+public:
+	// Creates a pool that keeps count keys of the number of primes, refilled by threads threads
+	RSAKeyPool(int count = 4, int primes = 2, int threads = 1);
+	// Stops the threads once their current keys are done
+	~RSAKeyPool();
+
+	RSAKeyPool(const RSAKeyPool&) = delete;
+	RSAKeyPool& operator=(const RSAKeyPool&) = delete;
+
+	// Changes how many keys of the number of primes (2 or 3) are kept ready
+	void setCapacity(int primes, int count);
+
+	// Takes a key of the number of primes, returns false if there is none ready
+	bool take(RSAPrivateKey &key, int primes = 2);
+	// Takes a key of the number of primes, or generates one if there is none ready
+	RSAPrivateKey get(int primes = 2);
+
+	// Gets the number of keys of the number of primes that are ready
+	int ready(int primes = 2);
+	// Gets a snapshot of the counters
+	RSAKeyPoolStats stats();
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef RSASCHEDULER_H
+#define RSASCHEDULER_H
+
+#include "RSAcipher.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Operations that can be queued in the scheduler
+enum RSARequestType
+{
+	RSA_DECRYPT,	// Private key operation
+	RSA_VERIFY		// Public key operation
+};
+
+// Counters of the scheduler since it was created
+struct RSASchedulerStats
+{
+	unsigned long long requests;		// Requests dispatched
+	unsigned long long batches;			// Batches dispatched
+	unsigned long long fullBatches;		// Batches dispatched because they reached the batch size
+	unsigned long long deadlineBatches;	// Batches dispatched because the oldest request hit the deadline
+	unsigned long long totalWaitUs;		// Sum of the time requests spent queued
+	unsigned long long maxWaitUs;		// Longest time a request spent queued
+	double fillRate;					// Dispatched requests over the batch slots offered (0..1)
+};
+
+// Collects individual requests for a short time and groups them by key and operation.
+// A group is dispatched when it reaches maxBatch requests, or when its oldest request
+// has waited for the deadline. The requests of a dispatched batch go to a queue that
+// every worker takes from one request at a time, so a batch runs on all the workers and
+// a group that reaches its deadline waits for one operation at most, not a whole batch.
+class RSAScheduler
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Request
+	{
+		BigInt<256> data;
+		std::promise<BigInt<256>> result;
+		Clock::time_point arrival;
+	};
+
+	typedef std::pair<RSACipher*, RSARequestType> GroupKey;
+
+	struct Task
+	{
+		GroupKey key;
+		Request request;
+	};
+
+	std::map<GroupKey, std::vector<Request>> groups;
+	std::deque<Task> tasks;
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable signal;
+	bool stopping;
+
+	int maxBatch;
+	Clock::duration deadline;
+	RSASchedulerStats counters;
+	unsigned long long slots;
+
+	std::future<BigInt<256>> submit(RSACipher &cipher, RSARequestType type, const BigInt<256> &data);
+	void run();
+	void release(Clock::time_point now, Clock::time_point &wake);
+	void execute(Task &task);
+
+public:
+	// Creates a scheduler with its batch size, deadline in microseconds and worker threads,
+	// one per hardware thread if workerCount is 0
+	RSAScheduler(int maxBatch = 16, int deadlineUs = 50, int workerCount = 0);
+	// Dispatches the remaining requests and stops the workers
+	~RSAScheduler();
+
+	RSAScheduler(const RSAScheduler&) = delete;
+	RSAScheduler& operator=(const RSAScheduler&) = delete;
+
+	// Queues a private key operation (256 Bytes) on the cipher
+	std::future<BigInt<256>> decrypt(RSACipher &cipher, const BigInt<256> &data);
+	// Queues a public key operation (256 Bytes) on the cipher
+	std::future<BigInt<256>> verify(RSACipher &cipher, const BigInt<256> &data);
+
+	// Changes the number of requests that fill a batch
+	void setMaxBatch(int size);
+	// Changes how long the oldest request of a group can wait (microseconds)
+	void setDeadline(int us);
+
+	// Gets a snapshot of the counters
+	RSASchedulerStats stats();
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef RSASIGNER_H
+#define RSASIGNER_H
+
+#include "RSAcipher.h"
+#include "SHA2.h"
+
+// Hash functions of the signatures
+enum RSAHashType
+{
+	RSA_SHA256,
+	RSA_SHA384
+};
+
+// Encodings of the signatures (RFC 8017)
+enum RSASignatureScheme
+{
+	RSA_PKCS1_V15,	// EMSA-PKCS1-v1_5, the same message always gives the same signature
+	RSA_PSS			// EMSA-PSS with MGF1 of the same hash and a salt as long as the digest
+};
+
+// Signs or verifies a message that arrives in chunks. Every chunk is hashed when it
+// is passed in, straight from the caller buffer, so the message is never buffered.
+// Signatures are as long as the modulus, in big endian byte order.
+class RSASigner
+{
+private:
+	RSACipher& cipher;
+	RSASignatureScheme scheme;
+	RSAHashType type;
+
+	SHA256 sha256;
+	SHA384 sha384;
+	Hash*  hash;
+
+public:
+	RSASigner(RSACipher &cipher, RSASignatureScheme scheme = RSA_PKCS1_V15, RSAHashType type = RSA_SHA256);
+
+	RSASigner(const RSASigner&) = delete;
+	RSASigner& operator=(const RSASigner&) = delete;
+
+	// Starts a new message
+	void reset();
+	// Hashes the next chunk of the message
+	void update(const void* data, size_t bytes);
+
+	// Signs the message with the private key and starts a new one.
+	// Returns the length of the signature, or 0 if it does not fit in size bytes.
+	int sign(unsigned char* signature, size_t size);
+	// Verifies a signature of the message with the public key and starts a new one
+	bool verify(const unsigned char* signature, size_t bytes);
+};
+
+// Signs a digest of the hash with the private key of the cipher.
+// Returns the length of the signature, or 0 if it does not fit in size bytes.
+int signDigest(RSACipher &cipher, RSASignatureScheme scheme, RSAHashType type,
+	const unsigned char* digest, unsigned char* signature, size_t size);
+
+// Verifies a signature of a digest of the hash with the public key of the cipher
+bool verifyDigest(RSACipher &cipher, RSASignatureScheme scheme, RSAHashType type,
+	const unsigned char* digest, const unsigned char* signature, size_t bytes);
+
+#endif
@@ -2,6 +2,10 @@
 #define RSACIPHER_H
 
 #include "CryptoPrime.h"
+#include "RSABlinding.h"
+#include "SHA2.h"
+#include <functional>
+#include <memory>
 
 struct RSAPublicKey
 {
@@ -9,6 +13,19 @@ struct RSAPublicKey
 	BigInt<256> publicExponent;
 };
 
+// Primes after the first two of a multi-prime key (RFC 8017 A.1.2)
+#define RSA_MAX_OTHER_PRIMES 2
+
+// Most primes of a generated key. OpenSSL checks 2048 bit keys for at most 3 primes.
+#define RSA_MAX_GENERATED_PRIMES 3
+
+struct RSAOtherPrimeInfo
+{
+	BigInt<256> prime;
+	BigInt<256> exponent;		// d mod (prime - 1)
+	BigInt<256> coefficient;	// Inverse of the product of the primes before it, mod prime
+};
+
 struct RSAPrivateKey
 {
 	BigInt<256> modulus;
@@ -19,15 +36,41 @@ struct RSAPrivateKey
 	BigInt<256> exponent1;
 	BigInt<256> exponent2;
 	BigInt<256> coefficient;
+
+	int otherPrimeCount = 0;
+	RSAOtherPrimeInfo otherPrimes[RSA_MAX_OTHER_PRIMES];
 };
 
-// Generates a new RSA Private Key
-RSAPrivateKey genPrivKey();
+// Padding of byte messages (RFC 8017 7)
+enum RSAPadding
+{
+	RSA_PAD_OAEP,	// RSAES-OAEP with SHA-256, MGF1 and an empty label
+	RSA_PAD_PKCS1	// RSAES-PKCS1-v1_5
+};
+
+// Generates a new RSA Private Key with 2 or 3 primes
+RSAPrivateKey genPrivKey(int primes = 2);
 
 // Gets the Public Key data from a Private Key
 RSAPublicKey  getPublicKey(const RSAPrivateKey &prk);
 
 
+// Counters of the fault check of private key operations
+struct RSAFaultStats
+{
+	unsigned long long checks;		// Results checked with the public exponent
+	unsigned long long faults;		// Results that did not match
+	unsigned long long recovered;	// Faulty results that were recomputed without the CRT
+};
+
+// Called on every fault with the counters after it
+typedef std::function<void(const RSAFaultStats&)> RSAFaultHook;
+
+// Private key operation modulo one prime of the key
+class RSAPrimeExponent;
+struct RSAFaultCheck;
+class RSAKeyPool;
+
 class RSACipher
 {
 private:
@@ -35,16 +78,46 @@ private:
 	RSAPrivateKey privateKey;
 	MontgomeryDomain<256> domain;
 
+	// Public exponent as a machine word, 0 if it does not fit into one
+	unsigned long long exponent;
+
+	// Private exponent in sliding windows
+	RecodedExponent privateExponent;
+
+	// CRT exponentiation of each prime, empty if the private key has no primes
+	std::vector<std::shared_ptr<RSAPrimeExponent>> crt;
+
+	// Blinding pairs of the private key, and whether private key operations use them
+	std::shared_ptr<RSABlinding> blinding;
+	bool blinded = true;
+
+	// Counters of the fault check, NULL if it is off
+	std::shared_ptr<RSAFaultCheck> faultCheck;
+
+	// Sets up the domain and the exponent of the keys
+	void prepare();
+	// Combines the results of the primes into the result modulo the modulus
+	BigInt<256> combine(const BigInt<256>* parts);
+	// Runs the private key operation on count numbers, with the primes or the private exponent
+	void privateOp(const BigInt<256>* data, BigInt<256>* out, int count, bool useCrt);
+	// Checks the results of private key operations with the public key
+	void checkResults(const BigInt<256>* data, BigInt<256>* out, int count);
+
 public:
 	RSACipher();
 	RSACipher(RSAPublicKey pu);
 	RSACipher(RSAPrivateKey pr);
 
-	// Generates new Private and Public key
-	void generate();
-	// Imports Public/Private keys from base64
-	void importPubKey(const char* data);
-	void importPrvKey(const char* data);
+	// Generates new Private and Public key with 2 or 3 primes
+	void generate(int primes = 2);
+	// Takes new keys with 2 or 3 primes from the pool, or generates them if it has none ready
+	void generate(RSAKeyPool &pool, int primes = 2);
+	// Gets the modulus of the keys
+	const BigInt<256>& getModulus() const;
+	// Imports Public/Private keys from base64. Returns -1 if the key is malformed or longer
+	// than 2048 bits, and keeps the previous keys, otherwise 0.
+	int importPubKey(const char* data);
+	int importPrvKey(const char* data);
 	// Exports Public/Private keys to base64
 	void exportPubKey(char* buffer, size_t size);
 	void exportPrvKey(char* buffer, size_t size);
@@ -53,6 +126,27 @@ public:
 	BigInt<256> encrypt(const BigInt<256> &data);
 	// Decrypts data (256 Bytes)
 	BigInt<256> decrypt(const BigInt<256> &data);
+
+	// Turns blinding of private key operations on or off (on by default)
+	void setBlinding(bool enabled);
+	// Turns checking the results of private key operations with the public key on or off
+	// (off by default). A result that fails is recomputed without the CRT, and -1 is thrown
+	// if that fails too. The hook is called on every failure. Copies of the cipher share the counters.
+	void setFaultCheck(bool enabled, RSAFaultHook hook = RSAFaultHook());
+	// Gets the counters of the fault check
+	RSAFaultStats faultStats() const;
+
+	// Encrypts a batch of count blocks (256 Bytes each) into out
+	void encrypt(const BigInt<256>* data, BigInt<256>* out, int count);
+	// Decrypts a batch of count blocks (256 Bytes each) into out
+	void decrypt(const BigInt<256>* data, BigInt<256>* out, int count);
+
+	// Pads and encrypts len bytes of a message into out, as many bytes as the modulus in big endian order.
+	// Returns the length of the ciphertext, or -1 if the message is too long or out is too small.
+	int encrypt(const unsigned char* data, size_t len, unsigned char* out, size_t size, RSAPadding padding = RSA_PAD_OAEP);
+	// Decrypts a ciphertext of len bytes and writes the message without the padding into out.
+	// Returns the length of the message, or -1 if the ciphertext or padding is invalid or out is too small.
+	int decrypt(const unsigned char* data, size_t len, unsigned char* out, size_t size, RSAPadding padding = RSA_PAD_OAEP);
 };
 
 
@@ -0,0 +1,75 @@
+#ifndef SHA2_H
+#define SHA2_H
+
+#include <cstddef>
+
+// Hash function that takes the message in pieces
+class Hash
+{
+public:
+	virtual ~Hash() {}
+
+	// Starts a new message
+	virtual void reset() = 0;
+	// Hashes the next bytes of the message
+	virtual void update(const void* data, size_t bytes) = 0;
+	// Writes the digest of the message, reset() has to be called before reuse
+	virtual void finish(unsigned char* digest) = 0;
+	// Size of the digest in bytes
+	virtual int size() const = 0;
+};
+
+// SHA-256 (FIPS 180-4). Whole blocks are hashed straight from the
+// buffer of update(), only the bytes of a partial block are copied.
+class SHA256 : public Hash
+{
+private:
+	unsigned int state[8];
+	unsigned char block[64];
+	unsigned long long length;
+
+	void compress(const unsigned char* data, size_t blocks);
+
+public:
+	static const int digestSize = 32;
+
+	SHA256();
+
+	void reset();
+	void update(const void* data, size_t bytes);
+	void finish(unsigned char* digest);
+	int size() const;
+
+	// Hashes a message in one call
+	static void hash(const void* data, size_t bytes, unsigned char* digest);
+};
+
+// SHA-384 (FIPS 180-4), the SHA-512 compression with its own initial
+// values and the digest truncated to 48 bytes.
+class SHA384 : public Hash
+{
+private:
+	unsigned long long state[8];
+	unsigned char block[128];
+	unsigned long long length;
+
+	void compress(const unsigned char* data, size_t blocks);
+
+public:
+	static const int digestSize = 48;
+
+	SHA384();
+
+	void reset();
+	void update(const void* data, size_t bytes);
+	void finish(unsigned char* digest);
+	int size() const;
+
+	// Hashes a message in one call
+	static void hash(const void* data, size_t bytes, unsigned char* digest);
+};
+
+// XORs len bytes of the MGF1 mask of a seed (RFC 8017 B.2.1) onto out
+void mgf1(Hash &hash, const unsigned char* seed, size_t seedLen, unsigned char* out, size_t len);
+
+#endif
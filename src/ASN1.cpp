@@ -157,4 +157,64 @@ int putInt(const char* src, size_t sSz, char* dst, size_t dSz, bool bigE)
 	bytes++;
 
 	return bytes;
-}
\ No newline at end of file
+}
+
+// Gets a sequence from an ASN1 encoded stream
+int getSequence(const char* buffer, size_t size, char* &seqPtr, size_t &bytes)
+{
+	bytes  = 0;
+	seqPtr = (char*)buffer;
+
+	size_t seqIndex = 0;
+
+	if(size >= 2 && buffer[0] == 48)
+	{	char sizeBytes = buffer[1];
+
+		if(sizeBytes < 0)
+		{	sizeBytes &= 0x7F;
+			for(seqIndex=2; sizeBytes>0; seqIndex++, sizeBytes--)
+			{	bytes <<= 8;
+				bytes |= (unsigned char)buffer[seqIndex];
+			}
+		}
+		else
+		{	bytes = sizeBytes;
+			seqIndex = 2;
+		}
+
+		seqPtr = (char*)buffer+seqIndex;
+	}
+
+	return bytes + seqIndex;
+}
+
+// Puts the header of a sequence into the end of a byte array, in front of
+// its content of the given bytes that follows the array
+int putSequence(size_t content, char* dst, size_t dSz)
+{
+	int bytes = 0;
+
+	// Paste size into the buffer
+	int sSize = 0;
+	for(size_t bCopy=content; bCopy>0; bCopy>>=8)
+	{	dst[dSz-bytes-1] = bCopy &0xFF;
+		bytes++;
+		sSize++;
+	}
+
+	// Add size size if it's more than one byte, or 0 for an empty sequence
+	if(sSize == 0)
+	{	dst[dSz-1] = 0;
+		bytes++;
+	}
+	else if(sSize>1 || dst[dSz-bytes]<0)
+	{	dst[dSz-bytes-1] = 0x80 + sSize;
+		bytes++;
+	}
+
+	// Add Structure tag
+	dst[dSz-bytes-1] = 48;
+	bytes++;
+
+	return bytes;
+}
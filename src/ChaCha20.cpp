@@ -0,0 +1,280 @@
+#include <rsa-crypt/ChaCha20.h>
+#include <string.h>
+
+static inline unsigned int rotl32(unsigned int x, int n)
+{	return (x << n) | (x >> (32 - n));
+}
+
+static inline unsigned int loadle32(const unsigned char* p)
+{	return p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static inline void storele32(unsigned char* p, unsigned int x)
+{	p[0] = (unsigned char)x;
+	p[1] = (unsigned char)(x >> 8);
+	p[2] = (unsigned char)(x >> 16);
+	p[3] = (unsigned char)(x >> 24);
+}
+
+static inline void storele64(unsigned char* p, unsigned long long x)
+{	storele32(p, (unsigned int)x);
+	storele32(p + 4, (unsigned int)(x >> 32));
+}
+
+//----------------------------------------------------------------------------//
+//                                   ChaCha20                                 //
+//--------------------------------------------------------------------------- //
+
+#define QUARTER_ROUND(a, b, c, d)				\
+	a += b; d ^= a; d = rotl32(d, 16);			\
+	c += d; b ^= c; b = rotl32(b, 12);			\
+	a += b; d ^= a; d = rotl32(d, 8);			\
+	c += d; b ^= c; b = rotl32(b, 7);
+
+// The state is "expand 32-byte k", the key, the counter and the nonce
+ChaCha20::ChaCha20(const unsigned char* key, const unsigned char* nonce, unsigned int counter)
+{
+	state[0] = 0x61707865;
+	state[1] = 0x3320646e;
+	state[2] = 0x79622d32;
+	state[3] = 0x6b206574;
+
+	for (int i = 0; i < 8; i++)
+	{	state[4 + i] = loadle32(key + i * 4);
+	}
+
+	state[12] = counter;
+	state[13] = loadle32(nonce);
+	state[14] = loadle32(nonce + 4);
+	state[15] = loadle32(nonce + 8);
+}
+
+// 10 double rounds of column and diagonal quarter rounds, then the input is added back
+void ChaCha20::block(unsigned char* out)
+{
+	unsigned int x[16];
+	memcpy(x, state, sizeof(x));
+
+	for (int i = 0; i < 10; i++)
+	{
+		QUARTER_ROUND(x[0], x[4], x[8],  x[12]);
+		QUARTER_ROUND(x[1], x[5], x[9],  x[13]);
+		QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+		QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+		QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+		QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+		QUARTER_ROUND(x[2], x[7], x[8],  x[13]);
+		QUARTER_ROUND(x[3], x[4], x[9],  x[14]);
+	}
+
+	for (int i = 0; i < 16; i++)
+	{	storele32(out + i * 4, x[i] + state[i]);
+	}
+
+	state[12]++;
+}
+
+void ChaCha20::crypt(const unsigned char* in, unsigned char* out, size_t len)
+{
+	unsigned char stream[64];
+
+	while (len > 0)
+	{
+		block(stream);
+
+		size_t n = len < 64 ? len : 64;
+		for (size_t i = 0; i < n; i++)
+		{	out[i] = in[i] ^ stream[i];
+		}
+
+		in  += n;
+		out += n;
+		len -= n;
+	}
+}
+
+//----------------------------------------------------------------------------//
+//                                   Poly1305                                 //
+//--------------------------------------------------------------------------- //
+
+// r is clamped as it is split into 26 bit limbs, s is kept for the end
+Poly1305::Poly1305(const unsigned char* key)
+	: used(0)
+{
+	r[0] = (loadle32(key)      ) & 0x3ffffff;
+	r[1] = (loadle32(key + 3)  >> 2) & 0x3ffff03;
+	r[2] = (loadle32(key + 6)  >> 4) & 0x3ffc0ff;
+	r[3] = (loadle32(key + 9)  >> 6) & 0x3f03fff;
+	r[4] = (loadle32(key + 12) >> 8) & 0x00fffff;
+
+	for (int i = 0; i < 4; i++)
+	{	pad[i] = loadle32(key + 16 + i * 4);
+		h[i] = 0;
+	}
+	h[4] = 0;
+}
+
+// h = (h + block + hibit) * r mod 2^130 - 5 for count 16 byte blocks. The limbs above 2^130
+// wrap around multiplied by 5, which is folded into the precomputed s = r * 5.
+void Poly1305::blocks(const unsigned char* data, size_t count, unsigned int hibit)
+{
+	const unsigned int mask = 0x3ffffff;
+	unsigned int r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+	unsigned int s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+	unsigned int h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+
+	for (; count > 0; count--, data += 16)
+	{
+		h0 += (loadle32(data)      ) & mask;
+		h1 += (loadle32(data + 3)  >> 2) & mask;
+		h2 += (loadle32(data + 6)  >> 4) & mask;
+		h3 += (loadle32(data + 9)  >> 6) & mask;
+		h4 += (loadle32(data + 12) >> 8) | hibit;
+
+		unsigned long long d0 = (unsigned long long)h0 * r0 + (unsigned long long)h1 * s4 + (unsigned long long)h2 * s3 + (unsigned long long)h3 * s2 + (unsigned long long)h4 * s1;
+		unsigned long long d1 = (unsigned long long)h0 * r1 + (unsigned long long)h1 * r0 + (unsigned long long)h2 * s4 + (unsigned long long)h3 * s3 + (unsigned long long)h4 * s2;
+		unsigned long long d2 = (unsigned long long)h0 * r2 + (unsigned long long)h1 * r1 + (unsigned long long)h2 * r0 + (unsigned long long)h3 * s4 + (unsigned long long)h4 * s3;
+		unsigned long long d3 = (unsigned long long)h0 * r3 + (unsigned long long)h1 * r2 + (unsigned long long)h2 * r1 + (unsigned long long)h3 * r0 + (unsigned long long)h4 * s4;
+		unsigned long long d4 = (unsigned long long)h0 * r4 + (unsigned long long)h1 * r3 + (unsigned long long)h2 * r2 + (unsigned long long)h3 * r1 + (unsigned long long)h4 * r0;
+
+		unsigned int c;
+		c = (unsigned int)(d0 >> 26); h0 = (unsigned int)d0 & mask; d1 += c;
+		c = (unsigned int)(d1 >> 26); h1 = (unsigned int)d1 & mask; d2 += c;
+		c = (unsigned int)(d2 >> 26); h2 = (unsigned int)d2 & mask; d3 += c;
+		c = (unsigned int)(d3 >> 26); h3 = (unsigned int)d3 & mask; d4 += c;
+		c = (unsigned int)(d4 >> 26); h4 = (unsigned int)d4 & mask;
+		h0 += c * 5;
+		c = h0 >> 26; h0 &= mask;
+		h1 += c;
+	}
+
+	h[0] = h0; h[1] = h1; h[2] = h2; h[3] = h3; h[4] = h4;
+}
+
+void Poly1305::update(const void* data, size_t bytes)
+{
+	const unsigned char* ptr = (const unsigned char*)data;
+
+	if (used)
+	{
+		size_t fill = 16 - used < bytes ? 16 - used : bytes;
+		memcpy(buffer + used, ptr, fill);
+		used  += fill;
+		ptr   += fill;
+		bytes -= fill;
+
+		if (used < 16)
+			return;
+
+		blocks(buffer, 1, 1 << 24);
+		used = 0;
+	}
+
+	blocks(ptr, bytes / 16, 1 << 24);
+	memcpy(buffer, ptr + bytes / 16 * 16, bytes & 15);
+	used = bytes & 15;
+}
+
+// The last partial block is padded with 1 and 0s instead of the high bit. h is fully reduced
+// by computing h + 5 - 2^130 and keeping it if it did not borrow, then s is added mod 2^128.
+void Poly1305::finish(unsigned char* tag)
+{
+	const unsigned int mask = 0x3ffffff;
+
+	if (used)
+	{	buffer[used++] = 1;
+		memset(buffer + used, 0, 16 - used);
+		blocks(buffer, 1, 0);
+		used = 0;
+	}
+
+	unsigned int h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4], c;
+	c = h1 >> 26; h1 &= mask; h2 += c;
+	c = h2 >> 26; h2 &= mask; h3 += c;
+	c = h3 >> 26; h3 &= mask; h4 += c;
+	c = h4 >> 26; h4 &= mask; h0 += c * 5;
+	c = h0 >> 26; h0 &= mask; h1 += c;
+
+	unsigned int g0 = h0 + 5; c = g0 >> 26; g0 &= mask;
+	unsigned int g1 = h1 + c; c = g1 >> 26; g1 &= mask;
+	unsigned int g2 = h2 + c; c = g2 >> 26; g2 &= mask;
+	unsigned int g3 = h3 + c; c = g3 >> 26; g3 &= mask;
+	unsigned int g4 = h4 + c - (1 << 26);
+
+	unsigned int keep = (g4 >> 31) - 1;
+	h0 = (h0 & ~keep) | (g0 & keep);
+	h1 = (h1 & ~keep) | (g1 & keep);
+	h2 = (h2 & ~keep) | (g2 & keep);
+	h3 = (h3 & ~keep) | (g3 & keep);
+	h4 = (h4 & ~keep) | (g4 & keep);
+
+	unsigned int w0 = h0 | (h1 << 26);
+	unsigned int w1 = (h1 >> 6)  | (h2 << 20);
+	unsigned int w2 = (h2 >> 12) | (h3 << 14);
+	unsigned int w3 = (h3 >> 18) | (h4 << 8);
+
+	unsigned long long f;
+	f = (unsigned long long)w0 + pad[0];             storele32(tag,      (unsigned int)f);
+	f = (unsigned long long)w1 + pad[1] + (f >> 32); storele32(tag + 4,  (unsigned int)f);
+	f = (unsigned long long)w2 + pad[2] + (f >> 32); storele32(tag + 8,  (unsigned int)f);
+	f = (unsigned long long)w3 + pad[3] + (f >> 32); storele32(tag + 12, (unsigned int)f);
+}
+
+//----------------------------------------------------------------------------//
+//                               ChaCha20-Poly1305                            //
+//--------------------------------------------------------------------------- //
+
+// The one-time key is the first half of key stream block 0, the message uses blocks 1 and up.
+// The tag covers aad || pad16 || ciphertext || pad16 || le64(aadLen) || le64(len).
+static void chachaPolyTag(ChaCha20 &chacha, const unsigned char* aad, size_t aadLen,
+	const unsigned char* ciphertext, size_t len, unsigned char* tag)
+{
+	static const unsigned char zeros[16] = { 0 };
+	unsigned char otk[64];
+	unsigned char lengths[16];
+
+	chacha.block(otk);
+	Poly1305 poly(otk);
+
+	poly.update(aad, aadLen);
+	poly.update(zeros, (16 - aadLen % 16) % 16);
+	poly.update(ciphertext, len);
+	poly.update(zeros, (16 - len % 16) % 16);
+
+	storele64(lengths, aadLen);
+	storele64(lengths + 8, len);
+	poly.update(lengths, 16);
+	poly.finish(tag);
+}
+
+void chachaPolySeal(const unsigned char* key, const unsigned char* nonce,
+	const unsigned char* aad, size_t aadLen, const unsigned char* in, size_t len,
+	unsigned char* out, unsigned char* tag)
+{
+	ChaCha20 chacha(key, nonce, 1);
+	chacha.crypt(in, out, len);
+
+	ChaCha20 otk(key, nonce, 0);
+	chachaPolyTag(otk, aad, aadLen, out, len, tag);
+}
+
+bool chachaPolyOpen(const unsigned char* key, const unsigned char* nonce,
+	const unsigned char* aad, size_t aadLen, const unsigned char* in, size_t len,
+	const unsigned char* tag, unsigned char* out)
+{
+	unsigned char expected[16];
+	unsigned char diff = 0;
+
+	ChaCha20 otk(key, nonce, 0);
+	chachaPolyTag(otk, aad, aadLen, in, len, expected);
+
+	for (int i = 0; i < 16; i++)
+	{	diff |= expected[i] ^ tag[i];
+	}
+	if (diff)
+		return false;
+
+	ChaCha20 chacha(key, nonce, 1);
+	chacha.crypt(in, out, len);
+	return true;
+}
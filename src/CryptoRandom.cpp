@@ -0,0 +1,160 @@
+#include <rsa-crypt/CryptoRandom.h>
+#include <rsa-crypt/ChaCha20.h>
+#include <atomic>
+
+#if defined(_MSC_VER)
+	#include <windows.h>
+	#include <bcrypt.h>
+	#pragma comment(lib, "bcrypt.lib")
+#else
+	#include <fcntl.h>
+	#include <pthread.h>
+	#include <unistd.h>
+	#if defined(__linux__)
+		#include <sys/random.h>
+	#endif
+#endif
+
+#if defined(__RDSEED__)
+	#include <immintrin.h>
+#endif
+
+// Bytes handed out between two reseeds from the operating system
+static const unsigned long long reseedInterval = 1 << 20;
+
+// Key stream blocks made at a time. The first 32 bytes are the next key, so the
+// bytes that were handed out can not be recovered from the state of the thread.
+static const int bufferBlocks = 16;
+
+struct RandomState
+{
+	unsigned char key[ChaCha20::keySize];
+	unsigned char buffer[ChaCha20::blockSize * bufferBlocks];
+	size_t used;
+	unsigned long long total;
+	unsigned int generation;
+	bool seeded;
+};
+
+// Gets the generator of the calling thread, zeroed until its first use
+static RandomState& random_state()
+{
+	static thread_local RandomState state;
+	return state;
+}
+
+// Counts the forks of the process. A child gets a copy of the state of its parent, so the
+// handler moves the child to a new generation, and a state of an older one is reseeded.
+static std::atomic<unsigned int> forkGeneration(0);
+
+#if !defined(_MSC_VER)
+static void onFork()
+{
+	forkGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+static const int forkHandler = pthread_atfork(NULL, NULL, onFork);
+#endif
+
+// Reads 32 bytes from the operating system: BCryptGenRandom on Windows, getrandom on Linux
+// and /dev/urandom elsewhere, or when getrandom is not there. The output of RDSEED is mixed
+// in when the compiler targets it.
+static void systemSeed(unsigned char* seed)
+{
+	size_t got = 0;
+
+#if defined(_MSC_VER)
+	if (BCryptGenRandom(NULL, seed, ChaCha20::keySize, BCRYPT_USE_SYSTEM_PREFERRED_RNG) == 0)
+		got = ChaCha20::keySize;
+#else
+	#if defined(__linux__)
+	while (got < ChaCha20::keySize)
+	{	ssize_t n = getrandom(seed + got, ChaCha20::keySize - got, 0);
+		if (n <= 0) break;
+		got += n;
+	}
+	#endif
+
+	if (got < ChaCha20::keySize)
+	{	int fd = open("/dev/urandom", O_RDONLY);
+		while (fd >= 0 && got < ChaCha20::keySize)
+		{	ssize_t n = read(fd, seed + got, ChaCha20::keySize - got);
+			if (n <= 0) break;
+			got += n;
+		}
+		if (fd >= 0) close(fd);
+	}
+#endif
+
+	if (got < ChaCha20::keySize)
+		throw -1;
+
+#if defined(__RDSEED__)
+	for (int i = 0; i < ChaCha20::keySize / 8; i++)
+	{	unsigned long long r;
+		for (int tries = 0; tries < 10 && !_rdseed64_step(&r); tries++);
+		for (int j = 0; j < 8; j++)
+		{	seed[i * 8 + j] ^= (unsigned char)(r >> (j * 8));
+		}
+	}
+#endif
+}
+
+// The new seed is XORed onto the key, so a reseed never loses what the key had
+static void reseed(RandomState &state)
+{
+	unsigned char seed[ChaCha20::keySize];
+	systemSeed(seed);
+
+	for (int i = 0; i < ChaCha20::keySize; i++)
+	{	state.key[i] ^= seed[i];
+	}
+	memset(seed, 0, sizeof(seed));
+
+	state.used       = sizeof(state.buffer);
+	state.total      = 0;
+	state.generation = forkGeneration.load(std::memory_order_relaxed);
+	state.seeded     = true;
+}
+
+static void refill(RandomState &state)
+{
+	static const unsigned char nonce[ChaCha20::nonceSize] = {};
+	ChaCha20 chacha(state.key, nonce);
+
+	for (int i = 0; i < bufferBlocks; i++)
+	{	chacha.block(state.buffer + i * ChaCha20::blockSize);
+	}
+
+	memcpy(state.key, state.buffer, ChaCha20::keySize);
+	memset(state.buffer, 0, ChaCha20::keySize);
+	state.used = ChaCha20::keySize;
+}
+
+void crypto_random(void* out, size_t len)
+{
+	RandomState &state = random_state();
+	unsigned char* dst = (unsigned char*)out;
+
+	if (!state.seeded || state.total >= reseedInterval || state.generation != forkGeneration.load(std::memory_order_relaxed))
+	{	reseed(state);
+	}
+	state.total += len;
+
+	while (len > 0)
+	{
+		if (state.used == sizeof(state.buffer))
+		{	refill(state);
+		}
+
+		size_t n = sizeof(state.buffer) - state.used;
+		if (n > len) n = len;
+
+		memcpy(dst, state.buffer + state.used, n);
+		memset(state.buffer + state.used, 0, n);
+
+		state.used += n;
+		dst += n;
+		len -= n;
+	}
+}
@@ -0,0 +1,94 @@
+#include <rsa-crypt/RSABlinding.h>
+#include <rsa-crypt/CryptoRandom.h>
+
+
+RSABlinding::RSABlinding(const MontgomeryDomain<256> &domain, const BigInt<256> &publicExponent, unsigned long long exponent)
+	: domain(domain), publicExponent(publicExponent), exponent(exponent), start(0)
+{
+	memcpy(&modulus, &domain.mod, 256);
+
+	for (int i = 0; i < RSA_BLINDING_SLOTS; i++)
+	{	slots[i].busy = false;
+		slots[i].ready = false;
+	}
+}
+
+// Picks a random r below the modulus that has an inverse, and raises it to the public exponent.
+// This is the only exponentiation, and it is a cheap one for the usual small exponents.
+// The inverse is checked with a Montgomery multiplication: r * (r^-1 * R) / R = 1.
+void RSABlinding::create(BigInt<512> &factor, BigInt<512> &inverse)
+{
+	BigInt<512> one(1);
+	BigInt<512> check;
+	BigInt<256> r;
+
+	do
+	{	r = crypto_rand<256>() % modulus;
+		inverse = domain.transform(crypto_inverse(r, modulus));
+
+		memcpy(&check, &r, 256);
+		domain.multiply(check, inverse);
+	} while (r.isZero() || check != one);
+
+	factor = domain.transform(r);
+	if (exponent)
+		crypto_pow(factor, exponent, domain);
+	else
+		crypto_pow(factor, publicExponent, domain);
+}
+
+// Takes the first free slot from a rotating start, so concurrent callers spread over the slots.
+// The pair is copied out and replaced by its square before the slot is released.
+// If every slot is taken, a new pair is made for this call only.
+void RSABlinding::next(BigInt<512> &factor, BigInt<512> &inverse)
+{
+	unsigned int first = start.fetch_add(1, std::memory_order_relaxed);
+
+	for (int i = 0; i < RSA_BLINDING_SLOTS; i++)
+	{
+		Slot &slot = slots[(first + i) % RSA_BLINDING_SLOTS];
+		bool expected = false;
+
+		if (!slot.busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+			continue;
+
+		if (!slot.ready)
+		{	create(slot.factor, slot.inverse);
+			slot.ready = true;
+		}
+
+		factor  = slot.factor;
+		inverse = slot.inverse;
+		domain.square(slot.factor);
+		domain.square(slot.inverse);
+
+		slot.busy.store(false, std::memory_order_release);
+		return;
+	}
+
+	create(factor, inverse);
+}
+
+// The data is reduced below the modulus first, since the domain only reduces products
+// of numbers that fit into the limbs of the modulus.
+BigInt<256> RSABlinding::blind(const BigInt<256> &data, BigInt<512> &inverse)
+{
+	BigInt<512> factor;
+	BigInt<512> x;
+
+	next(factor, inverse);
+
+	BigInt<256> reduced = data < modulus ? data : data % modulus;
+	memcpy(&x, &reduced, 256);
+	domain.multiply(x, factor);
+	return BigInt<256>((const void*)&x);
+}
+
+BigInt<256> RSABlinding::unblind(const BigInt<256> &data, BigInt<512> &inverse)
+{
+	BigInt<512> x;
+
+	memcpy(&x, &data, 256);
+	domain.multiply(x, inverse);
+	return BigInt<256>((const void*)&x);
+}
@@ -0,0 +1,240 @@
+#include <rsa-crypt/RSAEnvelope.h>
+#include <future>
+#include <thread>
+
+// "RSAE", version, algorithm (1 = ChaCha20-Poly1305), chunk size and key length
+static const unsigned char magic[4] = { 'R', 'S', 'A', 'E' };
+static const int headerSize = 12;
+static const int chachaPoly = 1;
+
+// Number of chunks every thread gets in a batch
+static const int chunksPerThread = 4;
+
+// KDF2 with SHA-256 (RFC 5990): the data key is SHA-256(Z || 00 00 00 01),
+// where Z is the random number of the encapsulation in k big endian bytes
+static void deriveKey(const BigInt<256> &z, int k, unsigned char* key)
+{
+	static const unsigned char counter[4] = { 0, 0, 0, 1 };
+	unsigned char secret[256];
+
+	for (int i = 0; i < k; i++)
+	{	secret[i] = z.bytes[k - 1 - i];
+	}
+
+	SHA256 sha;
+	sha.update(secret, k);
+	sha.update(counter, 4);
+	sha.finish(key);
+}
+
+// The nonce of a chunk is its index in bytes 3-10 (big endian) and a flag in byte 11
+// that is set on the last chunk, so chunks can not be reordered, dropped or cut off
+static void chunkNonce(unsigned long long index, bool last, unsigned char* nonce)
+{
+	nonce[0] = nonce[1] = nonce[2] = 0;
+	for (int i = 0; i < 8; i++)
+	{	nonce[3 + i] = (unsigned char)(index >> (56 - i * 8));
+	}
+	nonce[11] = last;
+}
+
+
+RSAEnvelope::RSAEnvelope(RSACipher &cipher, size_t chunkSize, int threads)
+	: cipher(cipher),
+	  chunkSize(chunkSize < 1 ? 1 : chunkSize > maxChunkSize ? (size_t)maxChunkSize : chunkSize),
+	  threads(threads < 1 ? 1 : threads)
+{
+}
+
+// Fills the slots of a batch with chunks of readSize bytes. A short read or the end of the stream
+// after a full read marks the last chunk, an empty stream still gives one empty chunk.
+bool RSAEnvelope::read(std::istream &in, Batch &batch, size_t chunk, size_t readSize)
+{
+	int slots = threads * chunksPerThread;
+	size_t slot = chunk + tagSize;
+
+	batch.data.resize(slots * slot);
+	batch.lengths.resize(slots);
+	batch.count = 0;
+	batch.last = false;
+
+	while (batch.count < slots && !batch.last)
+	{
+		in.read((char*)&batch.data[batch.count * slot], readSize);
+		size_t n = (size_t)in.gcount();
+
+		batch.lengths[batch.count++] = n;
+		batch.last = n < readSize || in.peek() == std::istream::traits_type::eof();
+	}
+
+	return !in.bad();
+}
+
+// Seals or opens the chunks of a batch in place. Thread t takes the chunks t, t + threads, ...
+bool RSAEnvelope::process(Batch &batch, bool seal, const unsigned char* key, const std::vector<unsigned char> &header, size_t chunk)
+{
+	size_t slot = chunk + tagSize;
+	std::vector<char> valid(threads, 1);
+
+	auto work = [&](int t)
+	{
+		unsigned char nonce[ChaCha20::nonceSize];
+
+		for (int i = t; i < batch.count; i += threads)
+		{
+			unsigned char* data = &batch.data[i * slot];
+			size_t n = batch.lengths[i];
+			chunkNonce(batch.first + i, batch.last && i == batch.count - 1, nonce);
+
+			if (seal)
+			{	chachaPolySeal(key, nonce, header.data(), header.size(), data, n, data, data + n);
+				batch.lengths[i] = n + tagSize;
+			}
+			else if (n < (size_t)tagSize || !chachaPolyOpen(key, nonce, header.data(), header.size(),
+				data, n - tagSize, data + n - tagSize, data))
+			{	valid[t] = 0;
+			}
+			else
+			{	batch.lengths[i] = n - tagSize;
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int t = 1; t < threads && t < batch.count; t++)
+	{	pool.push_back(std::thread(work, t));
+	}
+	work(0);
+
+	for (size_t i = 0; i < pool.size(); i++)
+	{	pool[i].join();
+	}
+
+	for (int t = 0; t < threads; t++)
+	{	if (!valid[t])
+			return false;
+	}
+	return true;
+}
+
+// Three stage pipeline over two batches: while the chunks of one batch are processed,
+// the next batch is read, and the batch before it was written.
+bool RSAEnvelope::run(std::istream &in, std::ostream &out, bool seal, const unsigned char* key, const std::vector<unsigned char> &header, size_t chunk)
+{
+	size_t readSize = seal ? chunk : chunk + tagSize;
+	size_t slot = chunk + tagSize;
+	Batch batches[2];
+
+	batches[0].first = 0;
+	if (!read(in, batches[0], chunk, readSize))
+		return false;
+
+	std::future<bool> job = std::async(std::launch::async, &RSAEnvelope::process, this,
+		std::ref(batches[0]), seal, key, std::cref(header), chunk);
+
+	for (int cur = 0;; cur ^= 1)
+	{
+		Batch &batch = batches[cur];
+		Batch &next  = batches[cur ^ 1];
+		bool readOk = true;
+
+		if (!batch.last)
+		{	next.first = batch.first + batch.count;
+			readOk = read(in, next, chunk, readSize);
+		}
+
+		if (!job.get() || !readOk)
+			return false;
+
+		if (!batch.last)
+		{	job = std::async(std::launch::async, &RSAEnvelope::process, this,
+				std::ref(next), seal, key, std::cref(header), chunk);
+		}
+
+		for (int i = 0; i < batch.count; i++)
+		{	out.write((const char*)&batch.data[i * slot], batch.lengths[i]);
+		}
+
+		if (!out)
+			return false;
+		if (batch.last)
+			return true;
+	}
+}
+
+// Picks a random z below the modulus, writes the header with z^e mod n and seals the payload
+// with the key derived from z. The top bits above the modulus are cleared so the loop rarely repeats.
+bool RSAEnvelope::seal(std::istream &in, std::ostream &out)
+{
+	const BigInt<256> &mod = cipher.getModulus();
+	int bits = mod.bitCount();
+	int k = (bits + 7) / 8;
+	BigInt<256> z;
+
+	if (bits < 64)
+		return false;
+
+	do
+	{	z = crypto_rand<256>();
+		memset(z.bytes + k, 0, 256 - k);
+		z.bytes[k - 1] &= 0xFF >> (k * 8 - bits);
+	} while (z >= mod || z.isZero());
+
+	BigInt<256> c = cipher.encrypt(z);
+
+	std::vector<unsigned char> header(headerSize + k);
+	memcpy(&header[0], magic, 4);
+	header[4]  = version;
+	header[5]  = chachaPoly;
+	header[6]  = (unsigned char)(chunkSize >> 24);
+	header[7]  = (unsigned char)(chunkSize >> 16);
+	header[8]  = (unsigned char)(chunkSize >> 8);
+	header[9]  = (unsigned char)chunkSize;
+	header[10] = (unsigned char)(k >> 8);
+	header[11] = (unsigned char)k;
+	for (int i = 0; i < k; i++)
+	{	header[headerSize + i] = c.bytes[k - 1 - i];
+	}
+
+	unsigned char key[SHA256::digestSize];
+	deriveKey(z, k, key);
+
+	out.write((const char*)header.data(), header.size());
+	if (!out)
+		return false;
+
+	return run(in, out, true, key, header, chunkSize);
+}
+
+// Checks the header, recovers z with the private key and opens the chunks with the
+// chunk size of the container. The whole header is the additional data of every chunk.
+bool RSAEnvelope::open(std::istream &in, std::ostream &out)
+{
+	const BigInt<256> &mod = cipher.getModulus();
+	int k = (mod.bitCount() + 7) / 8;
+
+	std::vector<unsigned char> header(headerSize);
+	in.read((char*)header.data(), headerSize);
+	if (in.gcount() != headerSize || memcmp(&header[0], magic, 4) != 0 ||
+		header[4] != version || header[5] != chachaPoly)
+		return false;
+
+	size_t chunk = ((size_t)header[6] << 24) | ((size_t)header[7] << 16) | ((size_t)header[8] << 8) | header[9];
+	int    len   = (header[10] << 8) | header[11];
+	if (chunk < 1 || chunk > maxChunkSize || len != k)
+		return false;
+
+	header.resize(headerSize + k);
+	in.read((char*)&header[headerSize], k);
+	if (in.gcount() != k)
+		return false;
+
+	BigInt<256> c((cstr)&header[headerSize], k, true);
+	if (c >= mod)
+		return false;
+
+	unsigned char key[SHA256::digestSize];
+	deriveKey(cipher.decrypt(c), k, key);
+
+	return run(in, out, false, key, header, chunk);
+}
@@ -0,0 +1,158 @@
+#include <rsa-crypt/RSAKeyPool.h>
+
+#if defined(_MSC_VER)
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <sys/resource.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+// Moves the calling thread to the lowest priority, so keys are only made on idle cores.
+// Linux applies the nice value of setpriority to a single thread id.
+static void lowerPriority()
+{
+#if defined(_MSC_VER)
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+	setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+#endif
+}
+
+// Keys of more primes than generated, or less than 2, are made with 2 primes
+static int kindOf(int primes)
+{
+	return primes < 2 || primes > RSA_MAX_GENERATED_PRIMES ? 0 : primes - 2;
+}
+
+
+RSAKeyPool::RSAKeyPool(int count, int primes, int threads)
+	: stopping(false), counters()
+{
+	for (int i = 0; i < kinds; i++)
+	{	capacity[i] = 0;
+		pending[i] = 0;
+	}
+	capacity[kindOf(primes)] = count < 0 ? 0 : count;
+
+	for (int i = 0; i < (threads < 1 ? 1 : threads); i++)
+	{	workers.push_back(std::thread(&RSAKeyPool::run, this));
+	}
+}
+
+RSAKeyPool::~RSAKeyPool()
+{
+	{	std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	signal.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{	workers[i].join();
+	}
+}
+
+void RSAKeyPool::setCapacity(int primes, int count)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	capacity[kindOf(primes)] = count < 0 ? 0 : count;
+	signal.notify_all();
+}
+
+bool RSAKeyPool::take(RSAPrivateKey &key, int primes)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	std::deque<RSAPrivateKey> &queue = keys[kindOf(primes)];
+
+	if (queue.empty())
+	{	counters.misses++;
+		return false;
+	}
+
+	key = queue.front();
+	queue.pop_front();
+	counters.taken++;
+
+	signal.notify_one();
+	return true;
+}
+
+RSAPrivateKey RSAKeyPool::get(int primes)
+{
+	RSAPrivateKey key;
+
+	if (!take(key, primes))
+	{	key = genPrivKey(primes);
+	}
+	return key;
+}
+
+int RSAKeyPool::ready(int primes)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return (int)keys[kindOf(primes)].size();
+}
+
+RSAKeyPoolStats RSAKeyPool::stats()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return counters;
+}
+
+// Keys being made count towards the capacity, so two threads never make the last missing key
+int RSAKeyPool::needed() const
+{
+	int res = -1;
+	int most = 0;
+
+	for (int i = 0; i < kinds; i++)
+	{
+		int missing = capacity[i] - (int)keys[i].size() - pending[i];
+		if (missing > most)
+		{	most = missing;
+			res = i;
+		}
+	}
+
+	return res;
+}
+
+// Worker loop. Makes a key without the lock for the kind that needs one the most,
+// or sleeps until a key is taken or a capacity changes.
+void RSAKeyPool::run()
+{
+	lowerPriority();
+
+	std::unique_lock<std::mutex> guard(lock);
+
+	while (!stopping)
+	{
+		int kind = needed();
+
+		if (kind < 0)
+		{	signal.wait(guard);
+			continue;
+		}
+
+		RSAPrivateKey key;
+		bool made = true;
+
+		pending[kind]++;
+		guard.unlock();
+		try
+		{	key = genPrivKey(kind + 2);
+		}
+		catch (...)
+		{	made = false;
+		}
+		guard.lock();
+		pending[kind]--;
+
+		// Without randomness from the system no thread can make keys, callers get the error
+		if (!made)
+			return;
+
+		keys[kind].push_back(key);
+		counters.generated++;
+	}
+}
@@ -0,0 +1,188 @@
+#include <rsa-crypt/RSAScheduler.h>
+
+
+RSAScheduler::RSAScheduler(int maxBatch, int deadlineUs, int workerCount)
+	: stopping(false), maxBatch(maxBatch < 1 ? 1 : maxBatch),
+	  deadline(std::chrono::microseconds(deadlineUs)), counters(), slots(0)
+{
+	if (workerCount < 1)
+	{	workerCount = (int)std::thread::hardware_concurrency();
+	}
+
+	for (int i = 0; i < (workerCount < 1 ? 1 : workerCount); i++)
+	{	workers.push_back(std::thread(&RSAScheduler::run, this));
+	}
+}
+
+RSAScheduler::~RSAScheduler()
+{
+	{	std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	signal.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{	workers[i].join();
+	}
+}
+
+std::future<BigInt<256>> RSAScheduler::decrypt(RSACipher &cipher, const BigInt<256> &data)
+{	return submit(cipher, RSA_DECRYPT, data);
+}
+
+std::future<BigInt<256>> RSAScheduler::verify(RSACipher &cipher, const BigInt<256> &data)
+{	return submit(cipher, RSA_VERIFY, data);
+}
+
+void RSAScheduler::setMaxBatch(int size)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	maxBatch = size < 1 ? 1 : size;
+	signal.notify_all();
+}
+
+void RSAScheduler::setDeadline(int us)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	deadline = std::chrono::microseconds(us);
+	signal.notify_all();
+}
+
+RSASchedulerStats RSAScheduler::stats()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	RSASchedulerStats res = counters;
+	res.fillRate = slots ? (double)counters.requests / slots : 0;
+	return res;
+}
+
+// Adds a request to the group of its key and operation. The workers are only woken up
+// when a new group appears (its deadline has to be tracked) or when a group fills up.
+std::future<BigInt<256>> RSAScheduler::submit(RSACipher &cipher, RSARequestType type, const BigInt<256> &data)
+{
+	Request req;
+	req.data = data;
+	req.arrival = Clock::now();
+	std::future<BigInt<256>> res = req.result.get_future();
+
+	std::lock_guard<std::mutex> guard(lock);
+	if (stopping)
+	{	req.result.set_exception(std::make_exception_ptr(-1));
+		return res;
+	}
+
+	std::vector<Request> &group = groups[GroupKey(&cipher, type)];
+	group.push_back(std::move(req));
+
+	if (group.size() == 1 || (int)group.size() == maxBatch)
+	{	signal.notify_one();
+	}
+
+	return res;
+}
+
+// Worker loop. Under the lock, dispatches the groups that are ready, then takes the oldest
+// queued request and runs it without the lock. With nothing queued, sleeps until the
+// earliest deadline of the pending groups, or until a group appears or fills up.
+void RSAScheduler::run()
+{
+	std::unique_lock<std::mutex> guard(lock);
+
+	while (true)
+	{
+		Clock::time_point wake = Clock::time_point::max();
+		release(Clock::now(), wake);
+
+		if (!tasks.empty())
+		{
+			Task task = std::move(tasks.front());
+			tasks.pop_front();
+
+			guard.unlock();
+			execute(task);
+			guard.lock();
+			continue;
+		}
+
+		if (stopping)
+		{	return;
+		}
+
+		if (wake == Clock::time_point::max())
+			signal.wait(guard);
+		else
+			signal.wait_until(guard, wake);
+	}
+}
+
+// Moves the requests of every group that is full or whose oldest request has reached the
+// deadline to the task queue, up to maxBatch requests per batch, and counts the batches.
+// The earliest deadline of the groups left pending is written to wake. Called under the lock.
+void RSAScheduler::release(Clock::time_point now, Clock::time_point &wake)
+{
+	size_t queued = tasks.size();
+
+	for (auto it = groups.begin(); it != groups.end();)
+	{
+		std::vector<Request> &group = it->second;
+		bool full = (int)group.size() >= maxBatch;
+
+		while (!group.empty() && (full || group.front().arrival + deadline <= now || stopping))
+		{
+			size_t count = group.size() < (size_t)maxBatch ? group.size() : (size_t)maxBatch;
+
+			counters.requests += count;
+			counters.batches++;
+			slots += maxBatch;
+			(full ? counters.fullBatches : counters.deadlineBatches)++;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				unsigned long long wait = std::chrono::duration_cast<std::chrono::microseconds>(now - group[i].arrival).count();
+				counters.totalWaitUs += wait;
+				if (wait > counters.maxWaitUs)
+				{	counters.maxWaitUs = wait;
+				}
+
+				Task task;
+				task.key = it->first;
+				task.request = std::move(group[i]);
+				tasks.push_back(std::move(task));
+			}
+
+			group.erase(group.begin(), group.begin() + count);
+			full = (int)group.size() >= maxBatch;
+		}
+
+		if (group.empty())
+		{	it = groups.erase(it);
+			continue;
+		}
+
+		Clock::time_point due = group.front().arrival + deadline;
+		if (due < wake)
+		{	wake = due;
+		}
+		it++;
+	}
+
+	// Wake the other workers for the requests this one does not take
+	if (tasks.size() > queued + 1)
+	{	signal.notify_all();
+	}
+}
+
+// Runs one request through the cipher and fulfills its promise
+void RSAScheduler::execute(Task &task)
+{
+	try
+	{
+		if (task.key.second == RSA_DECRYPT)
+			task.request.result.set_value(task.key.first->decrypt(task.request.data));
+		else
+			task.request.result.set_value(task.key.first->encrypt(task.request.data));
+	}
+	catch (...)
+	{	task.request.result.set_exception(std::current_exception());
+	}
+}
@@ -0,0 +1,216 @@
+#include <rsa-crypt/RSASigner.h>
+
+// DER encoded DigestInfo in front of the digest in PKCS#1 v1.5 signatures (RFC 8017 9.2)
+static const unsigned char sha256Info[19] =
+{	0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+	0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20 };
+
+static const unsigned char sha384Info[19] =
+{	0x30, 0x41, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+	0x65, 0x03, 0x04, 0x02, 0x02, 0x05, 0x00, 0x04, 0x30 };
+
+// Picks the hash of the type from the ones given and starts a new message
+static Hash& selectHash(RSAHashType type, SHA256 &sha256, SHA384 &sha384)
+{
+	Hash& hash = type == RSA_SHA384 ? (Hash&)sha384 : (Hash&)sha256;
+	hash.reset();
+	return hash;
+}
+
+static int hashSize(RSAHashType type)
+{
+	return type == RSA_SHA384 ? SHA384::digestSize : SHA256::digestSize;
+}
+
+// Converts big endian bytes into a number
+static BigInt<256> fromBytes(const unsigned char* bytes, int len)
+{
+	return BigInt<256>((cstr)bytes, len, true);
+}
+
+// Writes the lowest len bytes of a number in big endian order
+static void toBytes(const BigInt<256> &num, unsigned char* bytes, int len)
+{
+	for (int i = 0; i < len; i++)
+	{	bytes[i] = num.bytes[len - 1 - i];
+	}
+}
+
+// XORs len bytes of the MGF1 mask of a seed with the hash of the type onto out
+static void maskWith(RSAHashType type, const unsigned char* seed, int seedLen, unsigned char* out, int len)
+{
+	SHA256 sha256;
+	SHA384 sha384;
+	mgf1(selectHash(type, sha256, sha384), seed, seedLen, out, len);
+}
+
+// EMSA-PKCS1-v1_5 encoding of a digest into emLen bytes: 00 01 FF..FF 00 DigestInfo digest.
+// At least 8 bytes of FF are required. Returns false if the encoding does not fit.
+static bool encodePKCS1(RSAHashType type, const unsigned char* digest, unsigned char* em, int emLen)
+{
+	const unsigned char* info = type == RSA_SHA384 ? sha384Info : sha256Info;
+	int hLen = hashSize(type);
+	int tLen = sizeof(sha256Info) + hLen;
+
+	if (emLen < tLen + 11)
+		return false;
+
+	em[0] = 0;
+	em[1] = 1;
+	memset(em + 2, 0xFF, emLen - tLen - 3);
+	em[emLen - tLen - 1] = 0;
+	memcpy(em + emLen - tLen, info, sizeof(sha256Info));
+	memcpy(em + emLen - hLen, digest, hLen);
+	return true;
+}
+
+// Hashes M' = 8 zero bytes, the digest of the message and the salt, for EMSA-PSS
+static void pssHash(RSAHashType type, const unsigned char* digest, const unsigned char* salt, unsigned char* out)
+{
+	static const unsigned char zeros[8] = { 0 };
+	SHA256 sha256;
+	SHA384 sha384;
+	Hash& hash = selectHash(type, sha256, sha384);
+
+	hash.update(zeros, 8);
+	hash.update(digest, hash.size());
+	hash.update(salt, hash.size());
+	hash.finish(out);
+}
+
+// Encodes the digest with the scheme and runs the private key operation on it.
+// EMSA-PSS leaves the top bit of the encoding clear so it is below the modulus:
+// emBits = modBits - 1, and the top 8*emLen - emBits bits of the masked block are cleared.
+int signDigest(RSACipher &cipher, RSASignatureScheme scheme, RSAHashType type,
+	const unsigned char* digest, unsigned char* signature, size_t size)
+{
+	int modBits = cipher.getModulus().bitCount();
+	int k = (modBits + 7) / 8;
+	int hLen = hashSize(type);
+	unsigned char em[256];
+	BigInt<256> m;
+
+	if (size < (size_t)k)
+		return 0;
+
+	if (scheme == RSA_PKCS1_V15)
+	{
+		if (!encodePKCS1(type, digest, em, k))
+			return 0;
+
+		m = fromBytes(em, k);
+	}
+	else
+	{
+		int emBits = modBits - 1;
+		int emLen = (emBits + 7) / 8;
+		int dbLen = emLen - hLen - 1;
+
+		if (emLen < hLen * 2 + 2)
+			return 0;
+
+		BigInt<SHA384::digestSize> salt = crypto_rand<SHA384::digestSize>();
+
+		// DB = 00..00 01 salt, then masked with MGF1 of H
+		memset(em, 0, dbLen - hLen - 1);
+		em[dbLen - hLen - 1] = 1;
+		memcpy(em + dbLen - hLen, salt.bytes, hLen);
+
+		pssHash(type, digest, salt.bytes, em + dbLen);
+		maskWith(type, em + dbLen, hLen, em, dbLen);
+		em[0] &= 0xFF >> (emLen * 8 - emBits);
+		em[emLen - 1] = 0xbc;
+
+		m = fromBytes(em, emLen);
+	}
+
+	toBytes(cipher.decrypt(m), signature, k);
+	return k;
+}
+
+// Runs the public key operation on the signature and checks its encoding.
+// PKCS#1 v1.5 encodings are compared to the encoding of the digest,
+// PSS encodings are unmasked and H is compared to the hash of the recovered salt.
+bool verifyDigest(RSACipher &cipher, RSASignatureScheme scheme, RSAHashType type,
+	const unsigned char* digest, const unsigned char* signature, size_t bytes)
+{
+	int modBits = cipher.getModulus().bitCount();
+	int k = (modBits + 7) / 8;
+	int hLen = hashSize(type);
+	unsigned char em[256];
+	unsigned char expected[256];
+
+	if (bytes != (size_t)k)
+		return false;
+
+	BigInt<256> s = fromBytes(signature, k);
+	if (s >= cipher.getModulus())
+		return false;
+
+	toBytes(cipher.encrypt(s), em, k);
+
+	if (scheme == RSA_PKCS1_V15)
+	{
+		return encodePKCS1(type, digest, expected, k) && memcmp(em, expected, k) == 0;
+	}
+
+	int emBits = modBits - 1;
+	int emLen = (emBits + 7) / 8;
+	int dbLen = emLen - hLen - 1;
+	unsigned char* e = em + k - emLen;
+	unsigned char  top = 0xFF >> (emLen * 8 - emBits);
+
+	if (emLen < hLen * 2 + 2 || (k > emLen && em[0] != 0))
+		return false;
+
+	if (e[emLen - 1] != 0xbc || (e[0] & ~top))
+		return false;
+
+	maskWith(type, e + dbLen, hLen, e, dbLen);
+	e[0] &= top;
+
+	for (int i = 0; i < dbLen - hLen - 1; i++)
+	{	if (e[i] != 0)
+			return false;
+	}
+	if (e[dbLen - hLen - 1] != 1)
+		return false;
+
+	pssHash(type, digest, e + dbLen - hLen, expected);
+	return memcmp(expected, e + dbLen, hLen) == 0;
+}
+
+
+RSASigner::RSASigner(RSACipher &cipher, RSASignatureScheme scheme, RSAHashType type)
+	: cipher(cipher), scheme(scheme), type(type)
+{
+	hash = type == RSA_SHA384 ? (Hash*)&sha384 : (Hash*)&sha256;
+}
+
+void RSASigner::reset()
+{
+	hash->reset();
+}
+
+void RSASigner::update(const void* data, size_t bytes)
+{
+	hash->update(data, bytes);
+}
+
+int RSASigner::sign(unsigned char* signature, size_t size)
+{
+	unsigned char digest[SHA384::digestSize];
+	hash->finish(digest);
+	hash->reset();
+
+	return signDigest(cipher, scheme, type, digest, signature, size);
+}
+
+bool RSASigner::verify(const unsigned char* signature, size_t bytes)
+{
+	unsigned char digest[SHA384::digestSize];
+	hash->finish(digest);
+	hash->reset();
+
+	return verifyDigest(cipher, scheme, type, digest, signature, bytes);
+}
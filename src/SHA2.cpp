@@ -0,0 +1,307 @@
+#include <rsa-crypt/SHA2.h>
+#include <string.h>
+
+static const unsigned int k256[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const unsigned long long k512[80] =
+{
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+	0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+	0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+	0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+	0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+	0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+	0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+	0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+	0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+	0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+	0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+	0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+	0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+	0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+static const unsigned int h256[8] =
+{
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static const unsigned long long h384[8] =
+{
+	0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+	0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL,
+};
+
+static inline unsigned int rotr32(unsigned int x, int n)
+{	return (x >> n) | (x << (32 - n));
+}
+
+static inline unsigned long long rotr64(unsigned long long x, int n)
+{	return (x >> n) | (x << (64 - n));
+}
+
+static inline unsigned int load32(const unsigned char* p)
+{	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+static inline unsigned long long load64(const unsigned char* p)
+{	return ((unsigned long long)load32(p) << 32) | load32(p + 4);
+}
+
+static inline void store32(unsigned char* p, unsigned int x)
+{	p[0] = (unsigned char)(x >> 24);
+	p[1] = (unsigned char)(x >> 16);
+	p[2] = (unsigned char)(x >> 8);
+	p[3] = (unsigned char)x;
+}
+
+static inline void store64(unsigned char* p, unsigned long long x)
+{	store32(p, (unsigned int)(x >> 32));
+	store32(p + 4, (unsigned int)x);
+}
+
+//----------------------------------------------------------------------------//
+//                                   SHA-256                                  //
+//--------------------------------------------------------------------------- //
+
+SHA256::SHA256()
+{	reset();
+}
+
+void SHA256::reset()
+{
+	memcpy(state, h256, sizeof(state));
+	length = 0;
+}
+
+int SHA256::size() const
+{	return digestSize;
+}
+
+// Runs the compression function over whole 64 byte blocks
+void SHA256::compress(const unsigned char* data, size_t blocks)
+{
+	unsigned int w[64];
+
+	for (; blocks > 0; blocks--, data += 64)
+	{
+		for (int i = 0; i < 16; i++)
+		{	w[i] = load32(data + i * 4);
+		}
+		for (int i = 16; i < 64; i++)
+		{	unsigned int s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			unsigned int s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		unsigned int a = state[0], b = state[1], c = state[2], d = state[3];
+		unsigned int e = state[4], f = state[5], g = state[6], h = state[7];
+
+		for (int i = 0; i < 64; i++)
+		{
+			unsigned int t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g)) + k256[i] + w[i];
+			unsigned int t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g; g = f; f = e; e = d + t1;
+			d = c; c = b; b = a; a = t1 + t2;
+		}
+
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+	}
+}
+
+// Fills the partial block first, then compresses the whole blocks in place
+// and keeps the rest of the bytes for the next call.
+void SHA256::update(const void* data, size_t bytes)
+{
+	const unsigned char* ptr = (const unsigned char*)data;
+	size_t used = (size_t)(length & 63);
+	length += bytes;
+
+	if (used)
+	{
+		size_t fill = 64 - used < bytes ? 64 - used : bytes;
+		memcpy(block + used, ptr, fill);
+		ptr += fill;
+		bytes -= fill;
+
+		if (used + fill < 64)
+			return;
+
+		compress(block, 1);
+	}
+
+	compress(ptr, bytes / 64);
+	memcpy(block, ptr + bytes / 64 * 64, bytes & 63);
+}
+
+// Pads the message with 0x80, 0s and the length in bits
+void SHA256::finish(unsigned char* digest)
+{
+	size_t used = (size_t)(length & 63);
+	unsigned long long bits = length << 3;
+
+	block[used++] = 0x80;
+	if (used > 56)
+	{	memset(block + used, 0, 64 - used);
+		compress(block, 1);
+		used = 0;
+	}
+	memset(block + used, 0, 56 - used);
+	store64(block + 56, bits);
+	compress(block, 1);
+
+	for (int i = 0; i < 8; i++)
+	{	store32(digest + i * 4, state[i]);
+	}
+}
+
+void SHA256::hash(const void* data, size_t bytes, unsigned char* digest)
+{
+	SHA256 sha;
+	sha.update(data, bytes);
+	sha.finish(digest);
+}
+
+//----------------------------------------------------------------------------//
+//                                   SHA-384                                  //
+//--------------------------------------------------------------------------- //
+
+SHA384::SHA384()
+{	reset();
+}
+
+void SHA384::reset()
+{
+	memcpy(state, h384, sizeof(state));
+	length = 0;
+}
+
+int SHA384::size() const
+{	return digestSize;
+}
+
+// Runs the SHA-512 compression function over whole 128 byte blocks
+void SHA384::compress(const unsigned char* data, size_t blocks)
+{
+	unsigned long long w[80];
+
+	for (; blocks > 0; blocks--, data += 128)
+	{
+		for (int i = 0; i < 16; i++)
+		{	w[i] = load64(data + i * 8);
+		}
+		for (int i = 16; i < 80; i++)
+		{	unsigned long long s0 = rotr64(w[i - 15], 1) ^ rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+			unsigned long long s1 = rotr64(w[i - 2], 19) ^ rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		unsigned long long a = state[0], b = state[1], c = state[2], d = state[3];
+		unsigned long long e = state[4], f = state[5], g = state[6], h = state[7];
+
+		for (int i = 0; i < 80; i++)
+		{
+			unsigned long long t1 = h + (rotr64(e, 14) ^ rotr64(e, 18) ^ rotr64(e, 41)) + ((e & f) ^ (~e & g)) + k512[i] + w[i];
+			unsigned long long t2 = (rotr64(a, 28) ^ rotr64(a, 34) ^ rotr64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g; g = f; f = e; e = d + t1;
+			d = c; c = b; b = a; a = t1 + t2;
+		}
+
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+	}
+}
+
+// Fills the partial block first, then compresses the whole blocks in place
+// and keeps the rest of the bytes for the next call.
+void SHA384::update(const void* data, size_t bytes)
+{
+	const unsigned char* ptr = (const unsigned char*)data;
+	size_t used = (size_t)(length & 127);
+	length += bytes;
+
+	if (used)
+	{
+		size_t fill = 128 - used < bytes ? 128 - used : bytes;
+		memcpy(block + used, ptr, fill);
+		ptr += fill;
+		bytes -= fill;
+
+		if (used + fill < 128)
+			return;
+
+		compress(block, 1);
+	}
+
+	compress(ptr, bytes / 128);
+	memcpy(block, ptr + bytes / 128 * 128, bytes & 127);
+}
+
+// Pads the message with 0x80, 0s and the length in bits as a 128 bit number
+void SHA384::finish(unsigned char* digest)
+{
+	size_t used = (size_t)(length & 127);
+
+	block[used++] = 0x80;
+	if (used > 112)
+	{	memset(block + used, 0, 128 - used);
+		compress(block, 1);
+		used = 0;
+	}
+	memset(block + used, 0, 112 - used);
+	store64(block + 112, length >> 61);
+	store64(block + 120, length << 3);
+	compress(block, 1);
+
+	for (int i = 0; i < 6; i++)
+	{	store64(digest + i * 8, state[i]);
+	}
+}
+
+void SHA384::hash(const void* data, size_t bytes, unsigned char* digest)
+{
+	SHA384 sha;
+	sha.update(data, bytes);
+	sha.finish(digest);
+}
+
+// The mask is the hashes of the seed followed by a 4 byte big endian counter, one after the other
+void mgf1(Hash &hash, const unsigned char* seed, size_t seedLen, unsigned char* out, size_t len)
+{
+	unsigned char digest[64];
+	unsigned char counter[4];
+
+	for (unsigned int c = 0; len > 0; c++)
+	{
+		store32(counter, c);
+
+		hash.reset();
+		hash.update(seed, seedLen);
+		hash.update(counter, 4);
+		hash.finish(digest);
+
+		size_t n = len < (size_t)hash.size() ? len : (size_t)hash.size();
+		for (size_t i = 0; i < n; i++)
+		{	out[i] ^= digest[i];
+		}
+		out += n;
+		len -= n;
+	}
+}
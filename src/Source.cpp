@@ -2,7 +2,7 @@
 #include <ctime>
 
 
-void main()
+int main()
 {
 	srand((unsigned int)time(NULL));
 	RSACipher rsa;
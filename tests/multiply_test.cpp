@@ -0,0 +1,90 @@
+// Checks limb_mul and limb_sqr against the schoolbook product on both sides of every
+// threshold the library is compiled with, and the Toom-3 kernels on their own.
+#include <bigint/bigint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const int thresholds[] = { BIGINT_KARATSUBA_THRESHOLD, BIGINT_KARATSUBA_SQR_THRESHOLD, BIGINT_TOOM3_THRESHOLD, BIGINT_TOOM3_SQR_THRESHOLD };
+
+static limb randomLimb()
+{
+	return ((limb)rand() << 40) ^ ((limb)rand() << 20) ^ rand();
+}
+
+// Multiplies operands of len limbs, random and with all bits set, by a second operand of
+// the same length and of just above the 2/3 Toom-3 needs. Returns the number of mismatches.
+static int checkLength(int len)
+{
+	int failures = 0;
+	int k = (len + 2) / 3;
+	int lengths[2] = { len, k * 2 + 1 };
+
+	for (int fill = 0; fill < 2; fill++)
+	for (int l = 0; l < 2; l++)
+	{
+		int nb = lengths[l];
+		std::vector<limb> a(len), b(nb), expected(len * 2), r(len * 2), scratch(len * 4 + 24 + limb_mul_scratch(len));
+		for (int i = 0; i < len; i++)
+		{	a[i] = fill ? ~(limb)0 : randomLimb();
+		}
+		for (int i = 0; i < nb; i++)
+		{	b[i] = fill ? ~(limb)0 : randomLimb();
+		}
+
+		limb_mul_basecase(&expected[0], &a[0], len, &b[0], nb);
+
+		limb_mul(&r[0], &a[0], len, &b[0], nb, &scratch[0]);
+		if (limb_cmp(&r[0], &expected[0], len + nb) != 0)
+		{	printf("limb_mul is wrong for %d by %d limbs\n", len, nb);
+			failures++;
+		}
+
+		if (len >= 8)
+		{	limb_mul_toom3(&r[0], &a[0], len, &b[0], nb, &scratch[0]);
+			if (limb_cmp(&r[0], &expected[0], len + nb) != 0)
+			{	printf("limb_mul_toom3 is wrong for %d by %d limbs\n", len, nb);
+				failures++;
+			}
+		}
+
+		if (l == 1)
+		{	continue;
+		}
+
+		limb_mul_basecase(&expected[0], &a[0], len, &a[0], len);
+
+		limb_sqr(&r[0], &a[0], len, &scratch[0]);
+		if (limb_cmp(&r[0], &expected[0], len * 2) != 0)
+		{	printf("limb_sqr is wrong for %d limbs\n", len);
+			failures++;
+		}
+
+		if (len >= 8)
+		{	limb_sqr_toom3(&r[0], &a[0], len, &scratch[0]);
+			if (limb_cmp(&r[0], &expected[0], len * 2) != 0)
+			{	printf("limb_sqr_toom3 is wrong for %d limbs\n", len);
+				failures++;
+			}
+		}
+	}
+
+	return failures;
+}
+
+int main()
+{
+	int failures = 0;
+
+	for (unsigned int i = 0; i < sizeof(thresholds) / sizeof(thresholds[0]); i++)
+	{	for (int len = thresholds[i] - 2; len <= thresholds[i] + 2; len++)
+		{	failures += checkLength(len);
+		}
+	}
+
+	// Three times the Toom-3 thresholds, so the parts of a level of Toom-3 go to Toom-3 again
+	failures += checkLength(BIGINT_TOOM3_THRESHOLD * 3 + 1) + checkLength(BIGINT_TOOM3_SQR_THRESHOLD * 3 + 1);
+
+	printf("%d failures\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+// Checks the primality tests against a sieve of the small numbers, on a domain of whole
+// limbs and on one that is not, and the strong Lucas test on its known pseudoprimes.
+#include <rsa-crypt/CryptoPrime.h>
+#include <cstdio>
+#include <vector>
+
+static const int SIEVE_LIMIT = 20000;
+
+// Strong Lucas pseudoprimes with Selfridge's parameters (OEIS A217255), which pass the
+// Lucas test on its own but not the base 2 strong test
+static const unsigned int lucasPseudoprimes[] = { 5459, 5777, 10877, 16109, 18971, 22499, 24569, 25199, 40309, 58519, 75077, 97439, 100127, 113573 };
+
+template <unsigned int N>
+int checkSieve(const std::vector<bool> &composite)
+{
+	int failures = 0;
+
+	for (int n = 3; n < SIEVE_LIMIT; n += 2)
+	{
+		BigInt<N> x((unsigned long long)n);
+		bool prime = !composite[n];
+
+		if (prime && !isPrimeLucas(x))
+		{	printf("isPrimeLucas<%u> rejects the prime %d\n", N, n);
+			failures++;
+		}
+		if (isPrimeBPSW(x) != prime)
+		{	printf("isPrimeBPSW<%u> is wrong for %d\n", N, n);
+			failures++;
+		}
+		if (isPrime(x, PRIME_BPSW) != prime)
+		{	printf("isPrime<%u> is wrong for %d\n", N, n);
+			failures++;
+		}
+	}
+
+	for (unsigned int i = 0; i < sizeof(lucasPseudoprimes) / sizeof(lucasPseudoprimes[0]); i++)
+	{
+		BigInt<N> x((unsigned long long)lucasPseudoprimes[i]);
+		if (!isPrimeLucas(x))
+		{	printf("isPrimeLucas<%u> rejects the pseudoprime %u\n", N, lucasPseudoprimes[i]);
+			failures++;
+		}
+		if (isPrimeBPSW(x))
+		{	printf("isPrimeBPSW<%u> accepts the pseudoprime %u\n", N, lucasPseudoprimes[i]);
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+int main()
+{
+	std::vector<bool> composite(SIEVE_LIMIT, false);
+	for (int i = 2; i * i < SIEVE_LIMIT; i++)
+	{	for (int j = i * i; !composite[i] && j < SIEVE_LIMIT; j += i)
+		{	composite[j] = true;
+		}
+	}
+
+	int failures = checkSieve<8>(composite) + checkSieve<32>(composite) + checkSieve<64>(composite) + checkSieve<12>(composite);
+
+	printf("%d failures\n", failures);
+	return failures ? 1 : 0;
+}
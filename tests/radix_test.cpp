@@ -0,0 +1,179 @@
+// Checks the hexadecimal, base64 and binary strings of numbers of every byte length against
+// a byte at a time encoding, and reading them back. Built with and without SSSE3, so both
+// paths are checked.
+#include <bigint/bigint.h>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+static const char hexDigits[] = "0123456789ABCDEF";
+static const char b64Digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Gets the bytes of the number without its leading zero bytes, most significant first.
+// Zero is one zero byte.
+template <unsigned int N>
+std::string bigEndian(const BigInt<N> &x)
+{
+	int len = N;
+	while (len > 1 && x.bytes[len - 1] == 0)
+	{	len--;
+	}
+
+	std::string res;
+	for (int i = len - 1; i >= 0; i--)
+	{	res += (char)x.bytes[i];
+	}
+	return res;
+}
+
+static std::string hexOf(const std::string &bytes)
+{
+	std::string res;
+	for (size_t i = 0; i < bytes.size(); i++)
+	{	res += hexDigits[(unsigned char)bytes[i] >> 4];
+		res += hexDigits[(unsigned char)bytes[i] & 15];
+	}
+
+	size_t zeros = 0;
+	while (zeros + 1 < res.size() && res[zeros] == '0')
+	{	zeros++;
+	}
+	return res.substr(zeros);
+}
+
+static std::string binaryOf(const std::string &bytes)
+{
+	std::string res;
+	for (size_t i = 0; i < bytes.size(); i++)
+	{	for (int bit = 7; bit >= 0; bit--)
+		{	res += (char)('0' + (((unsigned char)bytes[i] >> bit) & 1));
+		}
+	}
+
+	size_t zeros = 0;
+	while (zeros + 1 < res.size() && res[zeros] == '0')
+	{	zeros++;
+	}
+	return res.substr(zeros);
+}
+
+static std::string base64Of(const std::string &bytes)
+{
+	std::string res;
+	for (size_t i = 0; i < bytes.size(); i += 3)
+	{
+		unsigned int v = (unsigned char)bytes[i] << 16;
+		if (i + 1 < bytes.size()) v |= (unsigned char)bytes[i + 1] << 8;
+		if (i + 2 < bytes.size()) v |= (unsigned char)bytes[i + 2];
+
+		res += b64Digits[v >> 18];
+		res += b64Digits[(v >> 12) & 63];
+		res += i + 1 < bytes.size() ? b64Digits[(v >> 6) & 63] : '=';
+		res += i + 2 < bytes.size() ? b64Digits[v & 63] : '=';
+	}
+	return res;
+}
+
+// Fills the lowest len bytes with random values and a top byte that is not zero
+template <unsigned int N>
+BigInt<N> randomOfLength(int len)
+{
+	BigInt<N> x;
+	for (int i = 0; i < len; i++)
+	{	x.bytes[i] = (unsigned char)rand();
+	}
+	if (len > 0)
+	{	x.bytes[len - 1] |= (unsigned char)(1 + rand() % 255);
+	}
+	return x;
+}
+
+template <unsigned int N>
+int checkStrings()
+{
+	int failures = 0;
+
+	for (int len = 0; len <= (int)N; len++)
+	{
+		BigInt<N> x = randomOfLength<N>(len);
+		std::string bytes = bigEndian(x);
+
+		if (x.toString(16) != hexOf(bytes))
+		{	printf("BigInt<%u> hexadecimal is wrong for %d bytes\n", N, len);
+			failures++;
+		}
+		if (x.toString(64) != base64Of(bytes))
+		{	printf("BigInt<%u> base64 is wrong for %d bytes\n", N, len);
+			failures++;
+		}
+		if (x.toString(2) != binaryOf(bytes))
+		{	printf("BigInt<%u> binary is wrong for %d bytes\n", N, len);
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+// Reads the digits back, and checks that a character that is not a digit is rejected
+// wherever it is
+template <unsigned int N>
+int checkRead(int base, std::string digits, const BigInt<N> &expected, const char* invalid)
+{
+	int failures = 0;
+	BigInt<N> x;
+
+	if (x.fromChars(digits.c_str(), (int)digits.size(), base) != 0 || x != expected)
+	{	printf("BigInt<%u> does not read back %d base %d digits\n", N, (int)digits.size(), base);
+		failures++;
+	}
+
+	for (const char* c = invalid; *c; c++)
+	{
+		std::string bad = digits;
+		bad[rand() % bad.size()] = *c;
+		if (x.fromChars(bad.c_str(), (int)bad.size(), base) != -1)
+		{	printf("BigInt<%u> reads %d base %d digits with '%c'\n", N, (int)bad.size(), base, *c);
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+template <unsigned int N>
+int checkReads()
+{
+	int failures = 0;
+
+	for (int len = 1; len <= (int)N; len++)
+	{
+		BigInt<N> x = randomOfLength<N>(len);
+		std::string hex = hexOf(bigEndian(x));
+		std::string lower = hex;
+		for (size_t i = 0; i < lower.size(); i++)
+		{	lower[i] = (char)tolower(lower[i]);
+		}
+
+		failures += checkRead(16, hex, x, "gG/:@`\xff");
+		failures += checkRead(16, lower, x, " x");
+		failures += checkRead(2, binaryOf(bigEndian(x)), x, "2/ \xb0");
+	}
+
+	return failures;
+}
+
+int main()
+{
+	int failures = checkStrings<8>() + checkStrings<64>() + checkStrings<256>();
+	failures += checkReads<8>() + checkReads<64>() + checkReads<256>();
+
+#if defined(_SSSE3)
+	printf("SSSE3: ");
+#else
+	printf("portable: ");
+#endif
+	printf("%d failures\n", failures);
+	return failures ? 1 : 0;
+}
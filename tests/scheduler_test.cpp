@@ -0,0 +1,83 @@
+// Checks that the scheduler returns the results of the cipher for requests coming from
+// several threads, dispatches full and deadline batches and counts every request.
+#include <rsa-crypt/RSAScheduler.h>
+#include <cstdio>
+#include <cstdlib>
+
+static const int THREADS  = 4;
+static const int REQUESTS = 24;
+
+int main()
+{
+	srand(26);
+	RSACipher rsa(genPrivKey());
+	int failures = 0;
+
+	BigInt<256> messages[THREADS * REQUESTS];
+	BigInt<256> ciphertexts[THREADS * REQUESTS];
+	for (int i = 0; i < THREADS * REQUESTS; i++)
+	{	messages[i] = BigInt<256>((unsigned long long)(i * 7919 + 1));
+		ciphertexts[i] = rsa.encrypt(messages[i]);
+	}
+
+	{
+		RSAScheduler scheduler(8, 2000, 3);
+		std::vector<std::future<BigInt<256>>> plain(THREADS * REQUESTS);
+		std::vector<std::future<BigInt<256>>> verified(THREADS * REQUESTS);
+		std::vector<std::thread> clients;
+
+		for (int t = 0; t < THREADS; t++)
+		{	clients.push_back(std::thread([&, t]()
+			{	for (int i = t * REQUESTS; i < (t + 1) * REQUESTS; i++)
+				{	plain[i] = scheduler.decrypt(rsa, ciphertexts[i]);
+					verified[i] = scheduler.verify(rsa, messages[i]);
+				}
+			}));
+		}
+		for (int t = 0; t < THREADS; t++)
+		{	clients[t].join();
+		}
+
+		for (int i = 0; i < THREADS * REQUESTS; i++)
+		{	if (plain[i].get() != messages[i])
+			{	printf("decrypt %d is wrong\n", i);
+				failures++;
+			}
+			if (verified[i].get() != ciphertexts[i])
+			{	printf("verify %d is wrong\n", i);
+				failures++;
+			}
+		}
+
+		// A lone request is only dispatched by its deadline
+		std::future<BigInt<256>> single = scheduler.decrypt(rsa, ciphertexts[0]);
+		if (single.get() != messages[0])
+		{	printf("the deadline request is wrong\n");
+			failures++;
+		}
+
+		RSASchedulerStats stats = scheduler.stats();
+		if (stats.requests != THREADS * REQUESTS * 2 + 1 || stats.batches != stats.fullBatches + stats.deadlineBatches)
+		{	printf("the counters do not add up: %llu requests, %llu batches\n", stats.requests, stats.batches);
+			failures++;
+		}
+		if (stats.fullBatches == 0 || stats.deadlineBatches == 0)
+		{	printf("expected full and deadline batches: %llu full, %llu deadline\n", stats.fullBatches, stats.deadlineBatches);
+			failures++;
+		}
+	}
+
+	// Requests still queued when the scheduler is destroyed are dispatched
+	std::future<BigInt<256>> pending;
+	{
+		RSAScheduler scheduler(8, 1000000);
+		pending = scheduler.decrypt(rsa, ciphertexts[1]);
+	}
+	if (pending.get() != messages[1])
+	{	printf("the request pending at destruction is wrong\n");
+		failures++;
+	}
+
+	printf("%d failures\n", failures);
+	return failures ? 1 : 0;
+}
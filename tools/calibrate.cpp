@@ -0,0 +1,168 @@
+// Measures the crossovers between the multiplication and squaring kernels on the host and
+// prints the threshold definitions to compile the library with. The thresholds are variables
+// here instead of constants, so every crossover is measured with the kernels below it tuned:
+// first one level of Karatsuba over schoolbook halves against the schoolbook method, then,
+// with the Karatsuba thresholds set, one level of Toom-3 against Karatsuba all the way down.
+// Before the definitions are printed, the products are checked around every threshold.
+static int karatsubaThreshold    = 4096;
+static int karatsubaSqrThreshold = 4096;
+static int toom3Threshold        = 4096;
+static int toom3SqrThreshold     = 4096;
+
+#define BIGINT_KARATSUBA_THRESHOLD karatsubaThreshold
+#define BIGINT_KARATSUBA_SQR_THRESHOLD karatsubaSqrThreshold
+#define BIGINT_TOOM3_THRESHOLD toom3Threshold
+#define BIGINT_TOOM3_SQR_THRESHOLD toom3SqrThreshold
+
+#include <bigint/bigint.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static const int karatsubaSizes[] = { 4, 6, 8, 12, 16, 20, 24, 32, 40, 48, 64, 96, 128, 192, 256 };
+static const int toom3Sizes[]     = { 32, 48, 64, 80, 96, 112, 128, 160, 192, 256, 320, 384, 512 };
+
+// Gets the fastest time of a kernel in nanoseconds per call, out of a few runs
+template <class F>
+double measure(int len, F kernel)
+{
+	int reps = 1 + (1 << 18) / (len * len);
+	double best = 1e30;
+
+	for (int run = 0; run < 7; run++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int i = 0; i < reps; i++)
+		{	kernel();
+		}
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		double ns = std::chrono::duration<double, std::nano>(end - start).count() / reps;
+		if (ns < best)
+		{	best = ns;
+		}
+	}
+
+	return best;
+}
+
+// Finds the threshold below the first size where the upper kernel is faster than the lower
+// kernel. Sizes where they are within 2% of each other count as a tie. The kernels are called
+// with the result, the operands, their length and the scratch memory.
+template <class L, class U>
+int threshold(const char* name, const char* lowerName, const char* upperName, const int* sizes, int count, L lower, U upper)
+{
+	int res = sizes[0];
+	bool found = false;
+
+	for (int s = 0; s < count; s++)
+	{
+		int len = sizes[s];
+		std::vector<limb> a(len), b(len), r(len * 2), scratch(len * 4 + 24 + limb_mul_scratch(len));
+		for (int i = 0; i < len; i++)
+		{	a[i] = ((limb)rand() << 40) ^ ((limb)rand() << 20) ^ rand();
+			b[i] = ((limb)rand() << 40) ^ ((limb)rand() << 20) ^ rand();
+		}
+
+		double low  = measure(len, [&]() { lower(&r[0], &a[0], &b[0], len, &scratch[0]); });
+		double high = measure(len, [&]() { upper(&r[0], &a[0], &b[0], len, &scratch[0]); });
+
+		printf("// %-8s %4d limbs  %-10s %10.1f ns  %-9s %10.1f ns\n", name, len, lowerName, low, upperName, high);
+
+		if (!found && high * 1.02 < low)
+		{	found = true;
+		}
+		if (!found)
+		{	res = len;
+		}
+	}
+
+	return res;
+}
+
+// Compares the products of limb_mul, limb_sqr and the Toom-3 kernels with the schoolbook
+// product for lengths on both sides of a threshold, with random operands and with all bits set,
+// and with a second operand of the same length or just above the 2/3 Toom-3 needs.
+// Prints the lengths of the first mismatch and returns false.
+static bool check(int threshold)
+{
+	for (int len = threshold - 2; len <= threshold + 2; len++)
+	{
+		if (len < 8)
+		{	continue;
+		}
+
+		int k = (len + 2) / 3;
+		int lengths[2] = { len, k * 2 + 1 };
+
+		for (int fill = 0; fill < 2; fill++)
+		for (int l = 0; l < 2; l++)
+		{
+			int nb = lengths[l];
+			std::vector<limb> a(len), b(nb), expected(len * 2), r(len * 2), scratch(len * 4 + 24 + limb_mul_scratch(len));
+			for (int i = 0; i < len; i++)
+			{	a[i] = fill ? ~(limb)0 : ((limb)rand() << 40) ^ ((limb)rand() << 20) ^ rand();
+			}
+			for (int i = 0; i < nb; i++)
+			{	b[i] = fill ? ~(limb)0 : ((limb)rand() << 40) ^ ((limb)rand() << 20) ^ rand();
+			}
+
+			limb_mul_basecase(&expected[0], &a[0], len, &b[0], nb);
+			limb_mul(&r[0], &a[0], len, &b[0], nb, &scratch[0]);
+			bool ok = limb_cmp(&r[0], &expected[0], len + nb) == 0;
+
+			limb_mul_toom3(&r[0], &a[0], len, &b[0], nb, &scratch[0]);
+			ok = ok && limb_cmp(&r[0], &expected[0], len + nb) == 0;
+
+			limb_mul_basecase(&expected[0], &a[0], len, &a[0], len);
+			limb_sqr(&r[0], &a[0], len, &scratch[0]);
+			ok = ok && limb_cmp(&r[0], &expected[0], len * 2) == 0;
+
+			limb_sqr_toom3(&r[0], &a[0], len, &scratch[0]);
+			ok = ok && limb_cmp(&r[0], &expected[0], len * 2) == 0;
+
+			if (!ok)
+			{	printf("// check failed for %d by %d limbs\n", len, nb);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+int main()
+{
+	const int kcount = sizeof(karatsubaSizes) / sizeof(karatsubaSizes[0]);
+	const int tcount = sizeof(toom3Sizes) / sizeof(toom3Sizes[0]);
+
+	int mul = threshold("multiply", "schoolbook", "karatsuba", karatsubaSizes, kcount,
+		[](limb* r, const limb* a, const limb* b, int len, limb*) { limb_mul_basecase(r, a, len, b, len); },
+		[](limb* r, const limb* a, const limb* b, int len, limb* s) { limb_mul_karatsuba(r, a, len, b, len, s); });
+	int sqr = threshold("square", "schoolbook", "karatsuba", karatsubaSizes, kcount,
+		[](limb* r, const limb* a, const limb*, int len, limb*) { limb_sqr_basecase(r, a, len); },
+		[](limb* r, const limb* a, const limb*, int len, limb* s) { limb_sqr_karatsuba(r, a, len, s); });
+
+	karatsubaThreshold    = mul;
+	karatsubaSqrThreshold = sqr;
+
+	int mul3 = threshold("multiply", "karatsuba", "toom3", toom3Sizes, tcount,
+		[](limb* r, const limb* a, const limb* b, int len, limb* s) { limb_mul(r, a, len, b, len, s); },
+		[](limb* r, const limb* a, const limb* b, int len, limb* s) { limb_mul_toom3(r, a, len, b, len, s); });
+	int sqr3 = threshold("square", "karatsuba", "toom3", toom3Sizes, tcount,
+		[](limb* r, const limb* a, const limb*, int len, limb* s) { limb_sqr(r, a, len, s); },
+		[](limb* r, const limb* a, const limb*, int len, limb* s) { limb_sqr_toom3(r, a, len, s); });
+
+	int checked[4] = { mul, sqr, mul3, sqr3 };
+	for (int i = 0; i < 4; i++)
+	{	if (!check(checked[i]))
+		{	return 1;
+		}
+	}
+
+	printf("#define BIGINT_KARATSUBA_THRESHOLD %d\n", mul);
+	printf("#define BIGINT_KARATSUBA_SQR_THRESHOLD %d\n", sqr);
+	printf("#define BIGINT_TOOM3_THRESHOLD %d\n", mul3);
+	printf("#define BIGINT_TOOM3_SQR_THRESHOLD %d\n", sqr3);
+	return 0;
+}